@@ -4,6 +4,7 @@
  * @brief Contains all of the macros for ANSI escape sequences
  */
 #pragma once
+#include <csi-encode.hpp>
 #include <type_traits>
 #include <str.hpp>
 
@@ -19,6 +20,10 @@ namespace ANSI {
 	inline constexpr const auto FORE{ "38;5" };
 	/// @brief Defines a color sequence as applying to the background layer.
 	inline constexpr const auto BACK{ "48;5" };
+	/// @brief Defines a 24-bit color sequence as applying to the foreground (text) layer.
+	inline constexpr const auto FORE_RGB{ "38;2" };
+	/// @brief Defines a 24-bit color sequence as applying to the background layer.
+	inline constexpr const auto BACK_RGB{ "48;2" };
 	/// @brief Color sequence end character.
 	inline constexpr const auto END{ "m" };
 
@@ -37,9 +42,35 @@ namespace ANSI {
 	/// @brief Used by some escape sequences to terminate a string.
 	inline constexpr const auto STRING_TERMINATOR{ '\0' };
 
-	template<typename... VT> inline constexpr auto make_sequence(const VT&... ch)
+	namespace _internal {
+		/// @brief	Append one component of an escape sequence to a string. Numbers are encoded with encode_param(), types that aren't characters, strings, or numbers fall back to str::stringify().
+		template<typename T>
+		inline void append_sequence_part(std::string& seq, const T& part)
+		{
+			if constexpr (sequence_char<T>)
+				seq.push_back(static_cast<char>(part));
+			else if constexpr (sequence_number<T>) {
+				const auto pos{ seq.size() };
+				seq.resize(pos + max_param_length_v<T>);
+				seq.resize(static_cast<std::size_t>(encode_param(seq.data() + pos, part) - seq.data()));
+			}
+			else if constexpr (std::is_convertible_v<const T&, std::string_view>)
+				seq.append(std::string_view{ part });
+			else seq.append(str::stringify(part));
+		}
+	}
+
+	/**
+	 * @brief			Build an escape sequence string from any number of characters, strings, & numbers.
+	 * @param ...parts	The components of the escape sequence, in order.
+	 * @returns			std::string
+	 */
+	template<typename... VT> inline std::string make_sequence(const VT&... parts)
 	{
-		return std::move(str::stringify(ch...));
+		std::string seq;
+		seq.reserve(16ull * sizeof...(VT));
+		(_internal::append_sequence_part(seq, parts), ...);
+		return seq;
 	}
 }
 
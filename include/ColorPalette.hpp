@@ -25,11 +25,18 @@
  *	{
  *		std::cout << myPalette(MyKeyType::TYPE1) << "red text" << color::reset;
  *	}
+ *
+ *	When KeyType is an enum with small, mostly contiguous values, color::EnumColorPalette<MyKeyType> accepts the same initializer
+ *	and stores pre-rendered sequences in a flat array instead, so lookups return a reference without hashing or copying.
  */
 #pragma once
 #include <setcolor.hpp>
 #include <make_exception.hpp>
+#include <algorithm>
+#include <sstream>
+#include <type_traits>
 #include <unordered_map>
+#include <vector>
 
 namespace color {
 	/**
@@ -139,4 +146,200 @@ namespace color {
 		virtual setcolor operator()() const { return reset(); }
 		explicit operator PaletteType() const { return _palette; }
 	};
-};
\ No newline at end of file
+
+	/**
+	 * @class	EnumColorPalette
+	 * @brief	Array-backed alternative to ColorPalette for enum keys.
+	 *\n		Each color is rendered to its escape sequence for every ColorDepth once, when the palette is built, and stored at the index of its enumerator.
+	 *\n		Lookups return the rendering for the color depth that is current at the time of the lookup, so RGB colors are downgraded the same way ColorPalette's are.
+	 *\n		Lookups return a reference to the stored sequence string, so there is no hashing, copying, or allocation per lookup.
+	 *\n		Because the sequences are plain strings, streams with rendition tracking don't see them; call RenditionState::invalidate() after inserting one into a tracked stream.
+	 *\n		The storage size is determined by the largest enumerator in the palette, so the enum must be dense: its enumerators should start near 0 & be mostly contiguous.
+	 *\n		Palettes with a negative enumerator, or an enumerator greater than or equal to MAX_ENUMERATORS, are rejected. Use ColorPalette for sparse enums.
+	 * @tparam KeyType	- An enum type with small, non-negative enumerator values.
+	 */
+	template<typename KeyType> requires std::is_enum_v<KeyType>
+	class EnumColorPalette {
+	public:
+		/// @brief	The maximum number of entries in the storage array, which is one more than the largest enumerator that may be used as a key.
+		static constexpr std::size_t MAX_ENUMERATORS{ 1024ull };
+
+	private:
+		using PaletteType = std::unordered_map<KeyType, setcolor>;
+
+		/// @brief	The number of color depths that each color is rendered for.
+		static constexpr std::size_t DEPTHS{ static_cast<std::size_t>(ColorDepth::TRUECOLOR) + 1ull };
+
+		struct Entry {
+			std::string color[DEPTHS];			///< @brief The rendered color sequence for each color depth.
+			std::string reset_color[DEPTHS];	///< @brief The reset sequence followed by the color sequence, for each color depth.
+			bool exists{ false };
+		};
+
+		std::vector<Entry> _palette;
+		bool _isActive{ false }; ///< @brief When false, an empty sequence will always be returned from the set() function. This can be used to programmatically enable/disable output colors depending on need.
+
+		/// @brief	Empty sequence returned while the palette is inactive.
+		static const std::string& placeholder()
+		{
+			static const std::string empty{};
+			return empty;
+		}
+		/// @brief	The sequence that resets all attributes.
+		static const std::string& reset_sequence()
+		{
+			static const std::string seq{ ANSI::make_fixed_sequence(ESC, CSI, '0', END).view() };
+			return seq;
+		}
+
+		/// @brief	Get the index of the current color depth in Entry's arrays.
+		static std::size_t depth_index() noexcept { return static_cast<std::size_t>(getColorDepth()); }
+
+		static std::size_t index_of(const KeyType& key) noexcept
+		{
+			return static_cast<std::size_t>(static_cast<std::make_unsigned_t<std::underlying_type_t<KeyType>>>(key));
+		}
+
+		/// @brief	Render every color of a key-color map into a flat array. Throws when a key can't be stored in an array of MAX_ENUMERATORS entries.
+		static std::vector<Entry> build(const PaletteType& palette) noexcept(false)
+		{
+			std::size_t size{ 0ull };
+			for (const auto& [key, _] : palette) {
+				if constexpr (std::is_signed_v<std::underlying_type_t<KeyType>>)
+					if (static_cast<std::underlying_type_t<KeyType>>(key) < 0)
+						throw make_exception("EnumColorPalette:\tEnumerators with negative values can't be used as keys!");
+				if (index_of(key) >= MAX_ENUMERATORS)
+					throw make_exception("EnumColorPalette:\tThe enumerator value ", static_cast<std::uintmax_t>(index_of(key)), " is too large to be used as a key; the limit is ", MAX_ENUMERATORS - 1ull, ". Use ColorPalette for sparse enums.");
+				size = std::max(size, index_of(key) + 1);
+			}
+			std::vector<const setcolor*> colors(size, nullptr);
+			for (const auto& [key, color] : palette)
+				colors[index_of(key)] = &color;
+
+			std::vector<Entry> entries;
+			entries.reserve(size);
+			for (const auto* color : colors) {
+				if (color == nullptr) {
+					entries.emplace_back();
+					continue;
+				}
+				auto& entry{ entries.emplace_back() };
+				entry.exists = true;
+				for (std::size_t depth{ 0ull }; depth < DEPTHS; ++depth) {
+					std::ostringstream ss;
+					RenditionState untracked; // so the full rendition is rendered
+					color->write(ss, untracked, static_cast<ColorDepth>(depth));
+					entry.color[depth] = ss.str();
+					entry.reset_color[depth] = reset_sequence() + entry.color[depth];
+				}
+			}
+			return entries;
+		}
+
+	public:
+		EnumColorPalette() = default;
+		/**
+		 * @brief			Constructor that renders every color in a key-color map.
+		 * @param palette	- Key-color map. Every key must be a non-negative enumerator less than MAX_ENUMERATORS.
+		 * @throws std::exception
+		 */
+		EnumColorPalette(const PaletteType& palette) noexcept(false) : _palette{ build(palette) }, _isActive{ true } {}
+		template<class... VT>
+		EnumColorPalette(VT... color_pairs) noexcept(false) : _palette{ build(PaletteType{ std::move(color_pairs)... }) }, _isActive{ true } {}
+
+		/**
+		 * @brief Retrieve the reference of this palette's isActive boolean, allowing it to be modified.
+		 * @returns bool&
+		 */
+		constexpr bool& isActive() { return _isActive; }
+
+		/**
+		 * @brief Set this palette as active or inactive.
+		 * @param new_state	- When true, the palette will be set to active.
+		 * @returns bool	- The previous state.
+		 */
+		constexpr bool setActive(const bool& new_state)
+		{
+			const auto copy{ _isActive };
+			_isActive = new_state;
+			return copy;
+		}
+
+		/**
+		 * @brief Set this palette as active or inactive.
+		 * @param active	- When true, palette is active.
+		 * @returns EnumColorPalette<KeyType>&
+		 */
+		constexpr auto& operator=(const bool& active)
+		{
+			_isActive = active;
+			return *this;
+		}
+		/**
+		 * @brief Reset this palette's key-color map.
+		 * @param palette	- New key-color map. Every key must be a non-negative enumerator less than MAX_ENUMERATORS.
+		 * @returns EnumColorPalette<KeyType>&
+		 * @throws std::exception
+		 */
+		auto& operator=(const PaletteType& palette) noexcept(false)
+		{
+			_palette = build(palette);
+			return *this;
+		}
+
+		/**
+		 * @brief Check if a given key exists in the palette.
+		 * @param key	- Key to check for.
+		 * @returns bool
+		 */
+		bool key_exists(const KeyType& key) const noexcept
+		{
+			const auto i{ index_of(key) };
+			return i < _palette.size() && _palette[i].exists;
+		}
+
+		/**
+		 * @brief Retrieve the rendered color sequence for the given key when active, otherwise returns an empty sequence.
+		 * @param key	- Key associated with the target color.
+		 * @returns const std::string&
+		 * @throws std::exception
+		 */
+		const std::string& set(const KeyType& key) const noexcept(false)
+		{
+			if (key_exists(key))
+				return _isActive ? _palette[index_of(key)].color[depth_index()] : placeholder();
+			if constexpr (var::Streamable<KeyType>)
+				throw make_exception("set(KeyType):\tKey not found: \"", key, "\"!");
+			throw make_exception("set(KeyType):\tKey not found!");
+		}
+
+		/**
+		 * @brief	Retrieve the sequence that resets all attributes when active, otherwise returns an empty sequence.
+		 * @returns const std::string&
+		 */
+		const std::string& reset() const noexcept
+		{
+			return _isActive ? reset_sequence() : placeholder();
+		}
+		/**
+		 * @brief	Retrieve a sequence that resets all attributes, then sets the color for the given key, when active. Otherwise returns an empty sequence, like ColorPalette::reset(KeyType).
+		 * @returns const std::string&
+		 * @throws std::exception	The palette is active & the key doesn't exist.
+		 */
+		const std::string& reset(const KeyType& key) const noexcept(false)
+		{
+			if (!_isActive)
+				return placeholder();
+			if (key_exists(key))
+				return _palette[index_of(key)].reset_color[depth_index()];
+			throw make_exception("reset(KeyType):\tKey not found!");
+		}
+
+		/**
+		 * @brief	Retrieve the rendered color sequence for the given key. You can use this with output stream operator<< as an inline console color changer.
+		 * @returns const std::string&
+		 */
+		const std::string& operator()(const KeyType& key) const { return set(key); }
+		const std::string& operator()() const { return reset(); }
+	};
+}
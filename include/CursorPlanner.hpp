@@ -0,0 +1,165 @@
+/**
+ * @file	CursorPlanner.hpp
+ * @author	radj307
+ * @brief	Contains the CursorPlanner class, which tracks the cursor position and moves it using the shortest available sequence.
+ */
+#pragma once
+#include <SequenceDefinitions.hpp>
+#include <OutputWriter.hpp>
+
+#include <string_view>
+
+namespace sys::term {
+	/**
+	 * @class	CursorPlanner
+	 * @brief	Cursor motion optimizer in the style of curses' mvcur.
+	 *\n		Given the current position, every motion that can reach the target is costed in bytes and the shortest one is emitted:
+	 *\n		- setCursorPosition
+	 *\n		- CursorHorizontalAbs, CursorForward, CursorBackward, carriage return, & backspace on the same row.
+	 *\n		- CursorUp & CursorDown in the same column.
+	 *\n		- CursorNextLine & CursorPrevLine, optionally followed by CursorForward.
+	 *\n		- Vertical motions combined with a horizontal motion.
+	 *\n		- Rewriting the characters between the cursor & the target, when the caller supplies them.
+	 *\n		Coordinates are zero-based, and (0, 0) is the top-left corner.
+	 */
+	class CursorPlanner {
+		unsigned _x{ 0u }, _y{ 0u };
+		bool _known{ false };
+		std::size_t _moves{ 0ull }, _bytes_emitted{ 0ull }, _bytes_saved{ 0ull };
+
+		/// @brief	Keep the shorter of two candidate motions.
+		static void consider(FixedSequence<>& best, const FixedSequence<>& candidate) noexcept
+		{
+			if (candidate.size() < best.size())
+				best = candidate;
+		}
+
+		/// @brief	Get the shortest purely horizontal motion from column `from` to column `to` on the current row.
+		static FixedSequence<> horizontal(const unsigned from, const unsigned to)
+		{
+			if (from == to)
+				return{};
+			auto best{ CursorHorizontalAbs(to + origin()) };
+			if (to == 0u)
+				consider(best, make_fixed_sequence('\r'));
+			else consider(best, make_fixed_sequence('\r', CursorForward(to)));
+			if (to > from)
+				consider(best, CursorForward(to - from));
+			else {
+				consider(best, CursorBackward(from - to));
+				if (from - to <= 3u) {
+					FixedSequence<> backspaces;
+					for (unsigned i{ to }; i < from; ++i)
+						backspaces.append('\b');
+					consider(best, backspaces);
+				}
+			}
+			return best;
+		}
+
+	public:
+		/// @brief	The value to add to zero-based coordinates before passing them to setCursorPosition & CursorHorizontalAbs.
+		static unsigned origin() noexcept { return !_internal::CURSOR_MIN_AXIS; }
+
+		CursorPlanner() = default;
+
+		/// @brief	Check if the cursor position is currently known.
+		bool isKnown() const noexcept { return _known; }
+		/// @brief	Retrieve the tracked column.
+		unsigned x() const noexcept { return _x; }
+		/// @brief	Retrieve the tracked row.
+		unsigned y() const noexcept { return _y; }
+
+		/// @brief	Forget the cursor position, forcing the next motion to use setCursorPosition.
+		void invalidate() noexcept { _known = false; }
+		/// @brief	Inform the planner that the cursor is at a known position, for example after it was moved by other means.
+		void setKnown(const unsigned x, const unsigned y) noexcept
+		{
+			_x = x;
+			_y = y;
+			_known = true;
+		}
+		/// @brief	Inform the planner that n printable characters were written, advancing the cursor on the current row.
+		void advance(const unsigned n = 1u) noexcept { _x += n; }
+
+		/**
+		 * @brief			Find the shortest sequence that moves the cursor from the tracked position to the target, without emitting it.
+		 * @param x			Target column.
+		 * @param y			Target row.
+		 * @param overwrite	Optional. The exact bytes that redraw the cells between the tracked column & the target column on the current row, using the active rendition.
+		 *					Only considered when the target is to the right of the cursor on the same row. Must not exceed the capacity of FixedSequence.
+		 * @returns			FixedSequence<>
+		 */
+		FixedSequence<> plan(const unsigned x, const unsigned y, const std::string_view overwrite = {}) const
+		{
+			auto best{ setCursorPosition(x + origin(), y + origin()) };
+			if (!_known)
+				return best;
+			if (y == _y) {
+				if (x == _x)
+					return{};
+				consider(best, horizontal(_x, x));
+				if (x > _x && overwrite.size() == x - _x && overwrite.size() <= FixedSequence<>::capacity())
+					consider(best, make_fixed_sequence(overwrite));
+				return best;
+			}
+			if (y > _y) {
+				const unsigned rows{ y - _y };
+				consider(best, make_fixed_sequence(CursorDown(rows), horizontal(_x, x)));
+				consider(best, make_fixed_sequence(CursorNextLine(rows), (x == 0u ? FixedSequence<>{} : CursorForward(x))));
+			}
+			else {
+				const unsigned rows{ _y - y };
+				consider(best, make_fixed_sequence(CursorUp(rows), horizontal(_x, x)));
+				consider(best, make_fixed_sequence(CursorPrevLine(rows), (x == 0u ? FixedSequence<>{} : CursorForward(x))));
+			}
+			return best;
+		}
+
+		/**
+		 * @brief			Append the shortest sequence that moves the cursor to the target, and update the tracked position.
+		 * @param w			The writer to append to.
+		 * @param x			Target column.
+		 * @param y			Target row.
+		 * @param overwrite	Optional. See plan().
+		 * @returns			std::size_t	The number of bytes that were appended.
+		 */
+		std::size_t moveTo(OutputWriter& w, const unsigned x, const unsigned y, const std::string_view overwrite = {})
+		{
+			const auto seq{ plan(x, y, overwrite) };
+			if (_known && x == _x && y == _y)
+				return 0ull;
+			w << seq;
+			++_moves;
+			_bytes_emitted += seq.size();
+			_bytes_saved += setCursorPosition(x + origin(), y + origin()).size() - seq.size();
+			setKnown(x, y);
+			return seq.size();
+		}
+		/**
+		 * @brief	Move the cursor to the target through the calling thread's OutputWriter, like Cursor::setPos.
+		 * @returns	std::size_t	The number of bytes that were written.
+		 */
+		std::size_t moveTo(const unsigned x, const unsigned y)
+		{
+			auto& writer{ getOutputWriter() };
+			const auto count{ moveTo(writer, x, y) };
+			writer.commit();
+			return count;
+		}
+
+		/// @brief	Retrieve the number of motions that were emitted.
+		std::size_t moveCount() const noexcept { return _moves; }
+		/// @brief	Retrieve the total number of bytes emitted for motions.
+		std::size_t bytesEmitted() const noexcept { return _bytes_emitted; }
+		/// @brief	Retrieve the number of bytes saved compared to using setCursorPosition for every motion.
+		std::size_t bytesSaved() const noexcept { return _bytes_saved; }
+		/// @brief	Reset the motion counters.
+		void resetCounters() noexcept
+		{
+			_moves = 0ull;
+			_bytes_emitted = 0ull;
+			_bytes_saved = 0ull;
+		}
+	};
+}
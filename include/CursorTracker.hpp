@@ -0,0 +1,459 @@
+/**
+ * @file	CursorTracker.hpp
+ * @author	radj307
+ * @brief	Contains the CursorTracker class, which follows the output written through TermAPI to keep a local copy of the cursor position.
+ */
+#pragma once
+#include <TermAPIQuery.hpp>
+#include <OutputWriter.hpp>
+
+#include <algorithm>
+#include <mutex>
+#include <optional>
+#include <string_view>
+#include <tuple>
+#include <utility>
+
+namespace sys::term {
+	/**
+	 * @class	CursorTracker
+	 * @brief	Shadow of the terminal's cursor position, which is updated from every flush of an OutputWriter to STDOUT.
+	 *\n		Follows printable characters (including line wraps at the known width), control characters, cursor motions, scrolling margins, & save/restore.
+	 *\n		While it is attached, getCursorPosition() (& therefore Cursor::getPos()) is answered locally, and only queries the terminal when the position is uncertain;
+	 *\n		for example after a reset, an unrecognized sequence that may move the cursor, or a switch between screen buffers.
+	 *\n		Output that doesn't go through an OutputWriter, such as std::cout, isn't seen; pass it to observe() or call invalidate() after writing it.
+	 *\n		Positions are 1-based (row, column) pairs, like the terminal's own cursor position report.
+	 */
+	class CursorTracker : public OutputObserver, public CursorShadow {
+		enum class State : unsigned char {
+			GROUND,
+			ESCAPE,
+			CSI,
+			STRING,			///< @brief Inside of an OSC, DCS, or other string, which doesn't move the cursor.
+			STRING_ESCAPE,
+			CHARSET,		///< @brief Received ESC ( or similar, which is followed by one more character.
+		};
+		static constexpr std::size_t MAX_PARAMS{ 4ull };
+
+		mutable std::mutex _mutex;
+		unsigned _width, _height;
+		unsigned _row{ 1u }, _col{ 1u };
+		bool _known{ false };
+		bool _pending_wrap{ false };	///< @brief The last column was just written; the next printable character wraps to the next line.
+		std::pair<unsigned, unsigned> _saved{ 1u, 1u };
+		unsigned _top{ 1u }, _bottom{ 0u };	///< @brief The scrolling margins. 0 for the bottom margin means the last row.
+		std::size_t _resyncs{ 0ull };
+		bool _newline_returns;	///< @brief The terminal driver translates LF to CR LF. (ONLCR)
+
+		// output parser state
+		State _state{ State::GROUND };
+		char _prefix{ '\0' }, _intermediate{ '\0' };
+		unsigned _params[MAX_PARAMS]{};
+		std::size_t _param_count{ 0ull };
+		unsigned char _utf8_remaining{ 0u };
+		char32_t _utf8_codepoint{ 0 };
+
+		unsigned height() const noexcept { return _height == 0u ? ~0u : _height; }
+		unsigned width() const noexcept { return _width == 0u ? ~0u : _width; }
+		unsigned bottom() const noexcept { return _bottom != 0u ? _bottom : height(); }
+		unsigned param(const std::size_t i, const unsigned default_value = 1u) const noexcept
+		{
+			return i < _param_count && _params[i] != 0u ? _params[i] : default_value;
+		}
+		static unsigned clamp(const unsigned value, const unsigned min, const unsigned max) noexcept
+		{
+			return value < min ? min : (value > max ? max : value);
+		}
+
+		/// @brief	Approximate the number of columns occupied by a character; 0 for combining marks & 2 for wide East Asian characters.
+		static unsigned char_width(const char32_t c) noexcept
+		{
+			if ((c >= 0x300 && c <= 0x36F) || (c >= 0x200B && c <= 0x200F) || (c >= 0xFE00 && c <= 0xFE0F))
+				return 0u;
+			if ((c >= 0x1100 && c <= 0x115F) || (c >= 0x2E80 && c <= 0xA4CF) || (c >= 0xAC00 && c <= 0xD7A3) || (c >= 0xF900 && c <= 0xFAFF)
+				|| (c >= 0xFE30 && c <= 0xFE4F) || (c >= 0xFF00 && c <= 0xFF60) || (c >= 0xFFE0 && c <= 0xFFE6) || (c >= 0x1F300 && c <= 0x1F64F)
+				|| (c >= 0x1F900 && c <= 0x1F9FF) || (c >= 0x20000 && c <= 0x3FFFD))
+				return 2u;
+			return 1u;
+		}
+
+		/// @brief	Move down one line, scrolling instead when the cursor is on the bottom margin.
+		void line_feed() noexcept
+		{
+			if (_height == 0u) // scrolling can't be followed without the height
+				_known = false;
+			else if (_row != bottom() && _row < _height)
+				++_row;
+		}
+		/// @brief	Move up one line, scrolling instead when the cursor is on the top margin.
+		void reverse_line_feed() noexcept
+		{
+			if (_row != _top && _row > 1u)
+				--_row;
+		}
+		void print(const char32_t c) noexcept
+		{
+			const auto width{ char_width(c) };
+			if (width == 0u)
+				return;
+			if (_width == 0u) { // wrapping can't be followed without the width
+				_known = false;
+				return;
+			}
+			if (_pending_wrap) {
+				_pending_wrap = false;
+				_col = 1u;
+				line_feed();
+			}
+			if (width == 2u && _col == _width) { // a wide character that doesn't fit wraps early
+				_col = 1u;
+				line_feed();
+			}
+			_col += width;
+			if (_col > _width) {
+				_col = _width;
+				_pending_wrap = true;
+			}
+		}
+		void control(const unsigned char c) noexcept
+		{
+			switch (c) {
+			case '\r':
+				_col = 1u;
+				_pending_wrap = false;
+				break;
+			case '\n': [[fallthrough]];
+			case '\v': [[fallthrough]];
+			case '\f':
+				line_feed();
+				if (_newline_returns)
+					_col = 1u;
+				_pending_wrap = false;
+				break;
+			case '\b':
+				if (_col == 1u || _pending_wrap) // terminals disagree about backspacing over a line wrap
+					_known = false;
+				else --_col;
+				_pending_wrap = false;
+				break;
+			case '\t':
+				_col = std::min(_width == 0u ? _col + 8u : _width, ((_col - 1u) / 8u + 1u) * 8u + 1u);
+				break;
+			default: // BEL, NUL, & friends don't move the cursor
+				break;
+			}
+		}
+		void escape(const char c) noexcept
+		{
+			_state = State::GROUND;
+			switch (c) {
+			case '[':
+				_state = State::CSI;
+				_prefix = _intermediate = '\0';
+				_param_count = 0ull;
+				for (auto& p : _params)
+					p = 0u;
+				break;
+			case ']': [[fallthrough]];
+			case 'P': [[fallthrough]];
+			case 'X': [[fallthrough]];
+			case '^': [[fallthrough]];
+			case '_':
+				_state = State::STRING;
+				break;
+			case '(': [[fallthrough]];
+			case ')': [[fallthrough]];
+			case '*': [[fallthrough]];
+			case '+':
+				_state = State::CHARSET;
+				break;
+			case '7':
+				_saved = { _row, _col };
+				break;
+			case '8':
+				std::tie(_row, _col) = _saved;
+				_pending_wrap = false;
+				break;
+			case 'D':
+				line_feed();
+				_pending_wrap = false;
+				break;
+			case 'E':
+				line_feed();
+				_col = 1u;
+				_pending_wrap = false;
+				break;
+			case 'M':
+				reverse_line_feed();
+				_pending_wrap = false;
+				break;
+			case 'H': [[fallthrough]];	// tab stops are no longer the default
+			case 'c':					// full reset
+				_known = false;
+				break;
+			default: // keypad modes & other sequences that don't move the cursor
+				break;
+			}
+		}
+		void csi(const char final) noexcept
+		{
+			if (_prefix == '?') {
+				// alternate screen buffers & origin mode change where the cursor is
+				if ((final == 'h' || final == 'l') && (param(0, 0u) == 6u || param(0, 0u) == 47u || param(0, 0u) == 1047u || param(0, 0u) == 1049u))
+					_known = false;
+				return;
+			}
+			if (_prefix != '\0' || _intermediate != '\0')
+				return; // private & intermediate sequences (DECSCUSR, DA2, ...) don't move the cursor
+			const auto n{ param(0) };
+			bool clears_wrap{ true };
+			switch (final) {
+			case 'A': { // vertical motions stop at the margins when they start inside of the scrolling region
+				const auto limit{ _row >= _top ? _top : 1u };
+				_row -= std::min(n, _row - std::min(limit, _row));
+				break;
+			}
+			case 'B': {
+				const auto limit{ _row <= bottom() ? bottom() : height() };
+				_row += std::min(n, limit - std::min(limit, _row));
+				break;
+			}
+			case 'C': _col = clamp(_col + n, 1u, width()); break;
+			case 'D': _col = _col > n ? _col - n : 1u; break;
+			case 'E': {
+				const auto limit{ _row <= bottom() ? bottom() : height() };
+				_row += std::min(n, limit - std::min(limit, _row));
+				_col = 1u;
+				break;
+			}
+			case 'F': {
+				const auto limit{ _row >= _top ? _top : 1u };
+				_row -= std::min(n, _row - std::min(limit, _row));
+				_col = 1u;
+				break;
+			}
+			case 'G': [[fallthrough]];
+			case '`': _col = clamp(param(0), 1u, width()); break;
+			case 'd': _row = clamp(param(0), 1u, height()); break;
+			case 'H': [[fallthrough]];
+			case 'f':
+				_row = clamp(param(0), 1u, height());
+				_col = clamp(param(1), 1u, width());
+				break;
+			case 'r': { // DECSTBM also moves the cursor to the home position; terminals ignore the request when the margins are invalid
+				const auto top{ param(0) }, bottom{ param(1, 0u) };
+				if (top >= (bottom != 0u ? bottom : height()) || bottom > height())
+					break;
+				if (_height == 0u && bottom != 0u) // the bottom margin can't be validated without the height
+					_known = false;
+				_top = top;
+				_bottom = bottom;
+				_row = _col = 1u;
+				break;
+			}
+			case 's': _saved = { _row, _col }; break;
+			case 'u': std::tie(_row, _col) = _saved; break;
+			case 'I': [[fallthrough]];	// tab motions depend on tab stops
+			case 'Z': [[fallthrough]];
+			case 'g':
+				_known = false;
+				break;
+			default: // SGR, erase, scroll, insert, & delete don't move the cursor
+				clears_wrap = false;
+				break;
+			}
+			if (clears_wrap)
+				_pending_wrap = false;
+		}
+
+		void feed(const char c) noexcept
+		{
+			const auto uc{ static_cast<unsigned char>(c) };
+			switch (_state) {
+			case State::GROUND:
+				if (_utf8_remaining != 0u && (uc & 0xC0u) == 0x80u) {
+					_utf8_codepoint = (_utf8_codepoint << 6u) | (uc & 0x3Fu);
+					if (--_utf8_remaining == 0u)
+						print(_utf8_codepoint);
+					return;
+				}
+				_utf8_remaining = 0u;
+				if (uc == 0x1Bu)
+					_state = State::ESCAPE;
+				else if (uc < 0x20u || uc == 0x7Fu)
+					control(uc);
+				else if (uc < 0x80u)
+					print(static_cast<char32_t>(uc));
+				else if ((uc & 0xE0u) == 0xC0u)
+					_utf8_codepoint = uc & 0x1Fu, _utf8_remaining = 1u;
+				else if ((uc & 0xF0u) == 0xE0u)
+					_utf8_codepoint = uc & 0x0Fu, _utf8_remaining = 2u;
+				else if ((uc & 0xF8u) == 0xF0u)
+					_utf8_codepoint = uc & 0x07u, _utf8_remaining = 3u;
+				break;
+			case State::ESCAPE:
+				escape(c);
+				break;
+			case State::CSI:
+				if (c >= '0' && c <= '9') {
+					if (_param_count == 0ull)
+						_param_count = 1ull;
+					if (_param_count <= MAX_PARAMS)
+						_params[_param_count - 1ull] = _params[_param_count - 1ull] * 10u + static_cast<unsigned>(c - '0');
+				}
+				else if (c == ';') {
+					if (_param_count == 0ull)
+						_param_count = 1ull;
+					++_param_count;
+				}
+				else if (c >= '<' && c <= '?')
+					_prefix = c;
+				else if (uc >= 0x20u && uc <= 0x2Fu)
+					_intermediate = c;
+				else if (uc >= 0x40u && uc <= 0x7Eu) {
+					_state = State::GROUND;
+					csi(c);
+				}
+				else { // malformed
+					_state = State::GROUND;
+					_known = false;
+				}
+				break;
+			case State::STRING:
+				if (uc == 0x07u)
+					_state = State::GROUND;
+				else if (uc == 0x1Bu)
+					_state = State::STRING_ESCAPE;
+				break;
+			case State::STRING_ESCAPE:
+				_state = c == '\\' ? State::GROUND : State::STRING;
+				break;
+			case State::CHARSET:
+				_state = State::GROUND;
+				break;
+			}
+		}
+
+		/// @brief	Check if the terminal driver translates LF to CR LF for STDOUT. This is always true on Windows, where the console does it.
+		static bool stdout_translates_newlines() noexcept
+		{
+		#ifdef OS_WIN
+			return true;
+		#else
+			termios attr{};
+			if (!isatty(STDOUT_FILENO) || tcgetattr(STDOUT_FILENO, &attr) != 0)
+				return true;
+			return (attr.c_oflag & OPOST) != 0 && (attr.c_oflag & ONLCR) != 0;
+		#endif
+		}
+
+	public:
+		/**
+		 * @brief			Constructor. The position is unknown until it is set with resync() or the first query.
+		 * @param width		The number of columns in the terminal, used to follow line wraps. 0 when unknown.
+		 * @param height	The number of rows in the terminal, used to clamp motions & follow scrolling. 0 when unknown.
+		 */
+		CursorTracker(const unsigned width, const unsigned height) noexcept : _width{ width }, _height{ height }, _newline_returns{ stdout_translates_newlines() } {}
+		CursorTracker(const CursorTracker&) = delete;
+		CursorTracker& operator=(const CursorTracker&) = delete;
+		~CursorTracker() noexcept override { detach(); }
+
+		/// @brief	Start following STDOUT & answering getCursorPosition(). Replaces any previously attached observer & cursor shadow.
+		void attach() noexcept
+		{
+			setOutputObserver(this);
+			setCursorShadow(this);
+		}
+		/// @brief	Stop following STDOUT & answering getCursorPosition(), if this tracker is attached.
+		void detach() noexcept
+		{
+			OutputObserver* observer{ this };
+			_internal::stdout_observer.compare_exchange_strong(observer, nullptr, std::memory_order_acq_rel);
+			CursorShadow* shadow{ this };
+			_internal::cursor_shadow.compare_exchange_strong(shadow, nullptr, std::memory_order_acq_rel);
+		}
+
+		/**
+		 * @brief			Change the size of the terminal, for example after SIGWINCH. Terminals reflow differently when resized, so this also forgets the position.
+		 * @param width		The number of columns in the terminal. 0 when unknown.
+		 * @param height	The number of rows in the terminal. 0 when unknown.
+		 */
+		void resize(const unsigned width, const unsigned height) noexcept
+		{
+			std::scoped_lock lock(_mutex);
+			_width = width;
+			_height = height;
+			_bottom = 0u;
+			_known = false;
+		}
+		/// @brief	Forget the position, so that the next request queries the terminal.
+		void invalidate() noexcept
+		{
+			std::scoped_lock lock(_mutex);
+			_known = false;
+		}
+
+		/// @brief	Update the shadow from output that was written to the terminal without going through an OutputWriter.
+		void observe(const std::string_view output) noexcept
+		{
+			std::scoped_lock lock(_mutex);
+			for (const char c : output)
+				feed(c);
+		}
+		void observe_output(const std::string_view output) noexcept override { observe(output); }
+
+		/// @brief	Get the 1-based (row, column) position of the cursor, or std::nullopt when it is uncertain.
+		std::optional<std::pair<unsigned, unsigned>> shadow_position() noexcept override
+		{
+			std::scoped_lock lock(_mutex);
+			if (!_known || _state != State::GROUND)
+				return std::nullopt;
+			return std::make_pair(_row, _col);
+		}
+		/// @brief	Set the position to the 1-based (row, column) position reported by the terminal.
+		void resync(const unsigned row, const unsigned column) noexcept override
+		{
+			std::scoped_lock lock(_mutex);
+			_row = row;
+			_col = column;
+			_pending_wrap = false;
+			if (_width != 0u && _col > _width) { // some terminals report the column past the right margin while a wrap is pending
+				_col = _width;
+				_pending_wrap = true;
+			}
+			_known = true;
+			++_resyncs;
+		}
+
+		/**
+		 * @brief	Get the 1-based (row, column) position of the cursor, querying the terminal only when the shadow is uncertain.
+		 * @returns	std::optional<std::pair<unsigned, unsigned>>	std::nullopt when the position is uncertain & the terminal didn't answer.
+		 */
+		std::optional<std::pair<unsigned, unsigned>> position()
+		{
+			if (auto pos{ shadow_position() }; pos.has_value())
+				return pos;
+			const auto reply{ query(make_sequence(ESC, CSI, "6n"), 'R') };
+			if (!reply.has_value())
+				return std::nullopt;
+			const auto pos{ _internal::parse_number_pair(std::string_view{ reply.value() }.substr(2ull, reply.value().size() - 3ull)) };
+			if (!pos.has_value())
+				return std::nullopt;
+			resync(static_cast<unsigned>(pos.value().first), static_cast<unsigned>(pos.value().second));
+			return std::make_pair(static_cast<unsigned>(pos.value().first), static_cast<unsigned>(pos.value().second));
+		}
+
+		/// @brief	Check if the position is currently known without querying the terminal.
+		bool isKnown() const noexcept
+		{
+			std::scoped_lock lock(_mutex);
+			return _known;
+		}
+		/// @brief	Get the number of times the position had to be read from the terminal.
+		std::size_t resyncCount() const noexcept
+		{
+			std::scoped_lock lock(_mutex);
+			return _resyncs;
+		}
+	};
+}
@@ -26,11 +26,11 @@ namespace color {
 		constexpr operator const unsigned char() const { return _format; }
 
 		/** @brief Bitwise AND */
-		constexpr const unsigned char operator&(const unsigned char& o) const { return static_cast<unsigned char>(!!_format & !!o); }
+		constexpr const unsigned char operator&(const unsigned char& o) const { return static_cast<unsigned char>(_format & o); }
 		/** @brief Bitwise OR  */
-		constexpr const unsigned char operator|(const unsigned char& o) const { return static_cast<unsigned char>(!!_format | !!o); }
+		constexpr const unsigned char operator|(const unsigned char& o) const { return static_cast<unsigned char>(_format | o); }
 		/** @brief Bitwise XOR */
-		constexpr const unsigned char operator^(const unsigned char& o) const { return static_cast<unsigned char>(!!_format ^ !!o); }
+		constexpr const unsigned char operator^(const unsigned char& o) const { return static_cast<unsigned char>(_format ^ o); }
 
 		// Declare enum vars
 		static const FormatFlag ///< @brief When adding new entries, make sure to add an equivalent statement in color::setcolor::operator<<
@@ -113,17 +113,17 @@ namespace color {
 		constexpr bool operator!=(auto&& o) const { return !operator==(std::forward<decltype(o)>(o)); }
 
 		/// @brief Bitwise OR operator.
-		constexpr unsigned char operator|(const unsigned char& o) const { return static_cast<unsigned char>(!!_fmt | !!o); }
+		constexpr unsigned char operator|(const unsigned char& o) const { return static_cast<unsigned char>(_fmt | o); }
 		/// @brief Bitwise AND operator.
-		constexpr unsigned char operator&(const unsigned char& o) const { return static_cast<unsigned char>(!!_fmt & !!o); }
+		constexpr unsigned char operator&(const unsigned char& o) const { return static_cast<unsigned char>(_fmt & o); }
 		/// @brief Bitwise XOR operator.
-		constexpr unsigned char operator^(const unsigned char& o) const { return static_cast<unsigned char>(!!_fmt ^ !!o); }
+		constexpr unsigned char operator^(const unsigned char& o) const { return static_cast<unsigned char>(_fmt ^ o); }
 		/// @brief Bitwise OR setter-operator.
-		constexpr unsigned char operator|=(const unsigned char& o) { return _fmt = static_cast<unsigned char>(!!_fmt | !!o); }
+		constexpr unsigned char operator|=(const unsigned char& o) { return _fmt = static_cast<unsigned char>(_fmt | o); }
 		/// @brief Bitwise AND setter-operator.
-		constexpr unsigned char operator&=(const unsigned char& o) { return _fmt = static_cast<unsigned char>(!!_fmt & !!o); }
+		constexpr unsigned char operator&=(const unsigned char& o) { return _fmt = static_cast<unsigned char>(_fmt & o); }
 		/// @brief Bitwise XOR setter-operator.
-		constexpr unsigned char operator^=(const unsigned char& o) { return _fmt = static_cast<unsigned char>(!!_fmt ^ !!o); }
+		constexpr unsigned char operator^=(const unsigned char& o) { return _fmt = static_cast<unsigned char>(_fmt ^ o); }
 	};
 }
 #ifndef COLOR_NO_GLOBALS
@@ -0,0 +1,257 @@
+/**
+ * @file	FrameScheduler.hpp
+ * @author	radj307
+ * @brief	Contains the FrameScheduler class, which coalesces updates to any number of views into at most one frame per tick.
+ */
+#pragma once
+#include <FrameTransaction.hpp>
+#include <OutputWriter.hpp>
+#include <make_exception.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <vector>
+
+namespace sys::term {
+	/**
+	 * @class	FrameScheduler
+	 * @brief	Renders views on a single background thread at a target frame rate.
+	 *\n		Views are marked dirty from any thread without locking; however many times a view is marked dirty during a tick, it is rendered at most once,
+	 *\n		& every view that is dirty at the same tick is rendered into the same frame, which is written with a single system call.
+	 *\n		When rendering & writing a frame takes longer than a tick, the ticks that passed in the meantime are dropped instead of being rendered late.
+	 *\n		While nothing is dirty, the render thread sleeps.
+	 */
+	class FrameScheduler {
+	public:
+		using clock = std::chrono::steady_clock;
+		/// @brief	Function that appends a view's output to the frame. Called on the render thread, without holding any of the scheduler's locks,
+		///			so it may call markDirty(), markAllDirty(), addView(), & removeView().
+		using render_function = std::function<void(OutputWriter&)>;
+
+		/**
+		 * @class	View
+		 * @brief	A region of output that is rendered by a FrameScheduler. Obtained from FrameScheduler::addView().
+		 */
+		class View {
+			friend class FrameScheduler;
+
+			FrameScheduler& _scheduler;
+			const render_function _render;
+			alignas(64) std::atomic<bool> _dirty{ false };
+			std::atomic<std::uint64_t> _coalesced{ 0ull };
+			std::atomic<bool> _removed{ false };
+
+		public:
+			View(FrameScheduler& scheduler, render_function render) : _scheduler{ scheduler }, _render{ std::move(render) } {}
+			View(const View&) = delete;
+			View& operator=(const View&) = delete;
+
+			/// @brief	Request that this view is rendered in the next frame. Lock-free, & safe to call from any thread at any rate.
+			void markDirty() noexcept
+			{
+				if (_dirty.exchange(true, std::memory_order_acq_rel))
+					_coalesced.fetch_add(1ull, std::memory_order_relaxed);
+				else _scheduler.wake();
+			}
+			/// @brief	Check if this view is waiting to be rendered.
+			bool isDirty() const noexcept { return _dirty.load(std::memory_order_acquire); }
+		};
+
+	private:
+		std::atomic<std::int64_t> _interval_ns;
+		const bool _synchronized;
+		mutable std::mutex _views_mutex;
+		std::vector<std::shared_ptr<View>> _views;
+		std::mutex _render_mutex;	///< @brief Held by the render thread while it renders a frame.
+		std::vector<std::shared_ptr<View>> _frame_views;	///< @brief The views being rendered in the current frame. Only used by the render thread.
+		std::atomic<std::uint32_t> _wake{ 0u };	///< @brief Incremented to wake the render thread while it is idle.
+		std::atomic<bool> _pending{ false };
+		std::atomic<bool> _stop{ false };
+		std::mutex _stop_mutex;
+		std::condition_variable _stopped;	///< @brief Interrupts the wait for the next tick when the scheduler is stopped.
+		std::atomic<std::uint64_t> _rendered{ 0ull }, _dropped{ 0ull };
+		std::uint64_t _removed_coalesced{ 0ull };	///< @brief Updates coalesced by views that were removed.
+		std::thread _thread;
+
+		/// @brief	Wake the render thread, unless a frame is already pending.
+		void wake()
+		{
+			if (_pending.exchange(true, std::memory_order_acq_rel))
+				return;
+			_wake.fetch_add(1u, std::memory_order_release);
+			_wake.notify_one();
+		}
+
+		/**
+		 * @brief	Render every dirty view into a single frame & write it. Returns false when nothing was dirty.
+		 *\n		The dirty views are collected under the lock & rendered after releasing it, so that render functions can modify the scheduler.
+		 */
+		bool renderFrame()
+		{
+			_pending.store(false, std::memory_order_release);
+			auto& writer{ getOutputWriter() };
+			std::scoped_lock render_lock(_render_mutex);
+			{
+				std::scoped_lock lock(_views_mutex);
+				for (const auto& view : _views)
+					if (view->_dirty.exchange(false, std::memory_order_acq_rel))
+						_frame_views.emplace_back(view);
+			}
+			std::optional<FrameTransaction> frame;
+			for (const auto& view : _frame_views) {
+				if (view->_removed.load(std::memory_order_acquire)) // removed by a render function earlier in this frame
+					continue;
+				if (!frame.has_value())
+					frame.emplace(writer, _synchronized);
+				view->_render(writer);
+			}
+			_frame_views.clear();
+			if (!frame.has_value())
+				return false;
+			frame->commit();
+			_rendered.fetch_add(1ull, std::memory_order_relaxed);
+			return true;
+		}
+
+		void run()
+		{
+			auto next{ clock::now() };
+			for (;;) {
+				const auto wake_count{ _wake.load(std::memory_order_acquire) };
+				if (_stop.load(std::memory_order_acquire))
+					break;
+				if (!_pending.load(std::memory_order_acquire)) {
+					_wake.wait(wake_count, std::memory_order_acquire); // returns immediately if wake() was called since wake_count was loaded
+					continue;
+				}
+				const auto now{ clock::now() };
+				if (next < now) // the scheduler was idle, so the next frame can be rendered immediately
+					next = now;
+				else {
+					std::unique_lock lock(_stop_mutex);
+					if (_stopped.wait_until(lock, next, [this] { return _stop.load(std::memory_order_acquire); }))
+						break;
+				}
+				const bool rendered{ renderFrame() };
+				if (!rendered)
+					continue;
+				const std::chrono::nanoseconds interval{ _interval_ns.load(std::memory_order_relaxed) };
+				const auto finished{ clock::now() };
+				next += interval;
+				if (finished > next) { // output fell behind; skip the ticks that were missed
+					const auto missed{ (finished - next) / interval + 1 };
+					_dropped.fetch_add(static_cast<std::uint64_t>(missed), std::memory_order_relaxed);
+					next += interval * missed;
+				}
+			}
+			renderFrame(); // present the final state of any views that are still dirty
+		}
+
+		static std::int64_t to_interval(const double fps) noexcept(false)
+		{
+			if (!(fps > 0.0))
+				throw make_exception("FrameScheduler:\tThe target frame rate must be greater than zero!");
+			return std::max<std::int64_t>(1ll, static_cast<std::int64_t>(1e9 / fps));
+		}
+
+	public:
+		/**
+		 * @brief				Constructor. Starts the render thread.
+		 * @param fps			The target frame rate, in frames per second.
+		 * @param synchronized	When true, each frame is wrapped in a synchronized update. Pass isSynchronizedOutputSupported() to use it when the terminal supports it.
+		 * @throws				std::exception	The frame rate isn't greater than zero.
+		 */
+		explicit FrameScheduler(const double fps = 60.0, const bool synchronized = false) noexcept(false) : _interval_ns{ to_interval(fps) }, _synchronized{ synchronized }
+		{
+			_thread = std::thread{ &FrameScheduler::run, this };
+		}
+		FrameScheduler(const FrameScheduler&) = delete;
+		FrameScheduler& operator=(const FrameScheduler&) = delete;
+		/// @brief	Destructor. Renders any views that are still dirty, then stops the render thread.
+		~FrameScheduler() { stop(); }
+
+		/// @brief	Render any views that are still dirty & stop the render thread. Views can't be rendered afterwards.
+		void stop()
+		{
+			{
+				std::scoped_lock lock(_stop_mutex);
+				_stop.store(true, std::memory_order_release);
+			}
+			_stopped.notify_one();
+			_wake.fetch_add(1u, std::memory_order_release);
+			_wake.notify_one();
+			if (_thread.joinable())
+				_thread.join();
+		}
+
+		/**
+		 * @brief			Add a view. Views are rendered in the order that they were added.
+		 * @param render	Function that appends the view's output to the frame. It is called on the render thread.
+		 * @returns			View&	The view, which remains valid until it is removed or the scheduler is destroyed.
+		 */
+		View& addView(render_function render)
+		{
+			std::scoped_lock lock(_views_mutex);
+			return *_views.emplace_back(std::make_shared<View>(*this, std::move(render)));
+		}
+		/**
+		 * @brief		Remove a view. The view isn't rendered after this returns, so when it is called from another thread it blocks while a frame is being rendered.
+		 *\n			No other thread may be using the view.
+		 * @param view	A view that was returned by addView().
+		 */
+		void removeView(const View& view)
+		{
+			{
+				std::scoped_lock lock(_views_mutex);
+				std::erase_if(_views, [this, &view](const auto& v) {
+					if (v.get() != &view)
+						return false;
+					_removed_coalesced += v->_coalesced.load(std::memory_order_relaxed);
+					v->_removed.store(true, std::memory_order_release);
+					return true;
+				});
+			}
+			if (std::this_thread::get_id() != _thread.get_id()) { // wait for a frame that may be rendering the view; render functions are on that frame's thread, so they don't wait
+				std::scoped_lock render_lock(_render_mutex);
+			}
+		}
+		/// @brief	Mark every view dirty.
+		void markAllDirty()
+		{
+			std::scoped_lock lock(_views_mutex);
+			for (const auto& view : _views)
+				view->markDirty();
+		}
+
+		/**
+		 * @brief		Set the target frame rate.
+		 * @param fps	The target frame rate, in frames per second.
+		 * @throws		std::exception	The frame rate isn't greater than zero.
+		 */
+		void setTargetFps(const double fps) noexcept(false) { _interval_ns.store(to_interval(fps), std::memory_order_relaxed); }
+		/// @brief	Get the target frame rate, in frames per second.
+		double getTargetFps() const noexcept { return 1e9 / static_cast<double>(_interval_ns.load(std::memory_order_relaxed)); }
+
+		/// @brief	Get the number of frames that were rendered.
+		std::uint64_t framesRendered() const noexcept { return _rendered.load(std::memory_order_relaxed); }
+		/// @brief	Get the number of updates that were merged into a frame that was already pending for the same view.
+		std::uint64_t updatesCoalesced() const
+		{
+			std::scoped_lock lock(_views_mutex);
+			std::uint64_t total{ _removed_coalesced };
+			for (const auto& view : _views)
+				total += view->_coalesced.load(std::memory_order_relaxed);
+			return total;
+		}
+		/// @brief	Get the number of ticks that were skipped because rendering & writing a frame took longer than a tick.
+		std::uint64_t framesDropped() const noexcept { return _dropped.load(std::memory_order_relaxed); }
+	};
+}
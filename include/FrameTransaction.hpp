@@ -0,0 +1,89 @@
+/**
+ * @file	FrameTransaction.hpp
+ * @author	radj307
+ * @brief	Contains the FrameTransaction class, which collects a frame of output & presents it to the terminal all at once.
+ */
+#pragma once
+#include <SequenceDefinitions.hpp>
+#include <TermAPIQuery.hpp>
+#include <OutputWriter.hpp>
+
+#include <optional>
+
+namespace sys::term {
+	/**
+	 * @class	FrameTransaction
+	 * @brief	Collects a frame of output in an OutputWriter & writes it with a single system call when it is committed.
+	 *\n		When the terminal supports synchronized output, the frame is also wrapped in a synchronized update (mode 2026),
+	 *\n		so the terminal presents it atomically even if it receives the write in several chunks.
+	 *\n		While a transaction on the calling thread's writer is open, the operator() method of every sequence functor appends to the frame.
+	 *\n		Output written with std::cout or printf isn't part of the frame.
+	 */
+	class FrameTransaction {
+		OutputWriter& _writer;
+		const bool _synchronized;
+		std::optional<OutputWriter::Batch> _batch;
+
+	public:
+		/**
+		 * @brief				Constructor. Begins the frame.
+		 * @param writer		The writer to collect the frame in.
+		 * @param synchronized	When true, the frame is wrapped in a synchronized update.
+		 */
+		FrameTransaction(OutputWriter& writer, const bool synchronized) : _writer{ writer }, _synchronized{ synchronized }
+		{
+			_batch.emplace(_writer);
+			if (_synchronized)
+				_writer << setSynchronizedOutput(true);
+		}
+		FrameTransaction(const FrameTransaction&) = delete;
+		FrameTransaction& operator=(const FrameTransaction&) = delete;
+		/// @brief	Destructor. Commits the frame if it is still open.
+		~FrameTransaction() { commit(); }
+
+		/// @brief	Check if the frame hasn't been committed yet.
+		bool isOpen() const noexcept { return _batch.has_value(); }
+		/// @brief	Check if the frame is wrapped in a synchronized update.
+		bool isSynchronized() const noexcept { return _synchronized; }
+		/// @brief	Get the number of bytes collected so far, including any output that was buffered before the frame began.
+		std::size_t size() const noexcept { return _writer.size(); }
+
+		/**
+		 * @brief		Append anything that can be appended to an OutputWriter to the frame.
+		 * @param value	A string, character, number, or escape sequence.
+		 * @returns		FrameTransaction&
+		 */
+		template<typename T> requires requires(OutputWriter& w, const T& v) { w << v; }
+		FrameTransaction& append(const T& value)
+		{
+			_writer << value;
+			return *this;
+		}
+		template<typename T> requires requires(OutputWriter& w, const T& v) { w << v; }
+		friend FrameTransaction& operator<<(FrameTransaction& frame, const T& value) { return frame.append(value); }
+
+		/**
+		 * @brief	End the frame & write it to the terminal. When the frame is nested in an outer batch, it is written when that batch ends instead.
+		 *\n		Does nothing if the frame was already committed.
+		 */
+		void commit()
+		{
+			if (!_batch.has_value())
+				return;
+			if (_synchronized)
+				_writer << setSynchronizedOutput(false);
+			_batch.reset();
+		}
+	};
+
+	/**
+	 * @brief			Begin a frame transaction. Synchronized output is used if isSynchronizedOutputSupported() reports that the terminal supports it;
+	 *\n				the first call may therefore query the terminal.
+	 * @param writer	The writer to collect the frame in. Defaults to the calling thread's STDOUT writer.
+	 * @returns			FrameTransaction
+	 */
+	[[nodiscard]] inline FrameTransaction beginFrame(OutputWriter& writer = getOutputWriter())
+	{
+		return FrameTransaction{ writer, isSynchronizedOutputSupported() };
+	}
+}
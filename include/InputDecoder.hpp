@@ -0,0 +1,578 @@
+/**
+ * @file	InputDecoder.hpp
+ * @author	radj307
+ * @brief	Contains the InputDecoder class, which incrementally converts the bytes a VT terminal sends to STDIN into typed input events.
+ *\n		Complements the KeyMode/setKeyMode, setMouseReporting, setBracketedPaste, & setFocusReporting functions in SequenceDefinitions.hpp.
+ */
+#pragma once
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <string_view>
+
+namespace sys::term {
+	/**
+	 * @enum	Key
+	 * @brief	Identifies the key that produced a key event.
+	 */
+	enum class Key : unsigned char {
+		NONE,
+		/// @brief	A printable character; see InputEvent::codepoint.
+		CHARACTER,
+		ENTER,
+		TAB,
+		BACKSPACE,
+		ESCAPE,
+		UP,
+		DOWN,
+		RIGHT,
+		LEFT,
+		HOME,
+		END,
+		INSERT,
+		DEL,
+		PAGE_UP,
+		PAGE_DOWN,
+		F1,
+		F2,
+		F3,
+		F4,
+		F5,
+		F6,
+		F7,
+		F8,
+		F9,
+		F10,
+		F11,
+		F12,
+	};
+
+	/**
+	 * @enum	KeyModifier
+	 * @brief	Bitflags for the modifier keys held during a key or mouse event. Uses the same bit layout as xterm's modifier parameter, minus one.
+	 */
+	enum class KeyModifier : unsigned char {
+		NONE = 0,
+		SHIFT = 1,
+		ALT = 2,
+		CTRL = 4,
+		META = 8,
+	};
+	inline constexpr KeyModifier operator|(const KeyModifier& l, const KeyModifier& r) { return static_cast<KeyModifier>(static_cast<unsigned char>(l) | static_cast<unsigned char>(r)); }
+	inline constexpr KeyModifier operator&(const KeyModifier& l, const KeyModifier& r) { return static_cast<KeyModifier>(static_cast<unsigned char>(l) & static_cast<unsigned char>(r)); }
+	inline constexpr KeyModifier& operator|=(KeyModifier& l, const KeyModifier& r) { return l = l | r; }
+
+	/**
+	 * @enum	MouseButton
+	 * @brief	Identifies the mouse button of a mouse event.
+	 */
+	enum class MouseButton : unsigned char {
+		NONE,
+		LEFT,
+		MIDDLE,
+		RIGHT,
+		WHEEL_UP,
+		WHEEL_DOWN,
+		WHEEL_LEFT,
+		WHEEL_RIGHT,
+	};
+	/**
+	 * @enum	MouseAction
+	 * @brief	Identifies what happened during a mouse event.
+	 */
+	enum class MouseAction : unsigned char {
+		PRESS,
+		RELEASE,
+		/// @brief	The mouse moved, possibly while a button was held.
+		MOVE,
+	};
+
+	/**
+	 * @enum	InputEventType
+	 * @brief	Identifies the type of an InputEvent, which determines which of its members are meaningful.
+	 */
+	enum class InputEventType : unsigned char {
+		/// @brief	A key press. Uses key, codepoint, & modifiers.
+		KEY,
+		/// @brief	An SGR (1006) mouse report. Uses button, action, modifiers, x, & y.
+		MOUSE,
+		/// @brief	Bracketed paste started.
+		PASTE_BEGIN,
+		/// @brief	Part of the pasted text, in data. Large pastes are split into several events.
+		PASTE,
+		/// @brief	Bracketed paste ended.
+		PASTE_END,
+		/// @brief	The terminal gained focus.
+		FOCUS_IN,
+		/// @brief	The terminal lost focus.
+		FOCUS_OUT,
+		/// @brief	A reply to a query, such as a cursor position or device attributes report. The entire sequence is in data.
+		REPLY,
+		/// @brief	A well-formed escape sequence that isn't recognized. The entire sequence is in data.
+		UNKNOWN,
+	};
+
+	/**
+	 * @struct	InputEvent
+	 * @brief	A single decoded input event.
+	 *\n		The data member refers to memory owned by the decoder or the caller's input, and is only valid during the callback that receives the event.
+	 */
+	struct InputEvent {
+		InputEventType type{ InputEventType::KEY };
+		Key key{ Key::NONE };
+		KeyModifier modifiers{ KeyModifier::NONE };
+		MouseButton button{ MouseButton::NONE };
+		MouseAction action{ MouseAction::PRESS };
+		/// @brief	The unicode codepoint of a Key::CHARACTER event. For control characters, this is the lowercase letter that was pressed with CTRL.
+		char32_t codepoint{ 0 };
+		/// @brief	The 1-based column of a mouse event.
+		unsigned x{ 0u };
+		/// @brief	The 1-based row of a mouse event.
+		unsigned y{ 0u };
+		std::string_view data;
+	};
+
+	/**
+	 * @class	InputDecoder
+	 * @brief	Incremental, allocation-free decoder for terminal input.
+	 *\n		Bytes can be passed in arbitrarily sized pieces; sequences & UTF-8 characters that are split across calls to feed() are reassembled.
+	 *\n		Escape sequences are collected in a fixed-size buffer & matched by final byte through lookup tables.
+	 *\n		Because a lone ESC is indistinguishable from the start of a sequence, call flush() once input has been idle for a short time to emit a pending ESC key.
+	 */
+	class InputDecoder {
+	public:
+		/// @brief	The maximum length of a single escape sequence. Longer sequences are discarded.
+		static constexpr std::size_t CAPACITY{ 256ull };
+		/// @brief	The maximum number of numeric parameters parsed from a CSI sequence.
+		static constexpr std::size_t MAX_PARAMS{ 8ull };
+		/// @brief	The number of consecutive calls to flush() that an unterminated OSC or DCS string survives before it is decoded as typed input instead.
+		static constexpr unsigned MAX_STRING_FLUSHES{ 4u };
+
+	private:
+		enum class State : unsigned char {
+			GROUND,
+			ESCAPE,
+			CSI,
+			SS3,
+			STRING,			///< @brief Inside of an OSC or DCS string.
+			STRING_ESCAPE,	///< @brief Received ESC inside of an OSC or DCS string.
+			PASTE,
+		};
+
+		static constexpr std::string_view PASTE_END_SEQUENCE{ "\x1b[201~" };
+
+		/// @brief	Maps the first parameter of "CSI <n> ~" sequences to keys.
+		static constexpr auto TILDE_KEYS{ [] {
+			std::array<Key, 35ull> table{};
+			table[1] = Key::HOME;
+			table[2] = Key::INSERT;
+			table[3] = Key::DEL;
+			table[4] = Key::END;
+			table[5] = Key::PAGE_UP;
+			table[6] = Key::PAGE_DOWN;
+			table[7] = Key::HOME;
+			table[8] = Key::END;
+			table[11] = Key::F1;
+			table[12] = Key::F2;
+			table[13] = Key::F3;
+			table[14] = Key::F4;
+			table[15] = Key::F5;
+			table[17] = Key::F6;
+			table[18] = Key::F7;
+			table[19] = Key::F8;
+			table[20] = Key::F9;
+			table[21] = Key::F10;
+			table[23] = Key::F11;
+			table[24] = Key::F12;
+			return table;
+		}() };
+		/// @brief	Maps the final byte of CSI & SS3 key sequences to keys.
+		static constexpr auto FINAL_KEYS{ [] {
+			std::array<Key, 128ull> table{};
+			table['A'] = Key::UP;
+			table['B'] = Key::DOWN;
+			table['C'] = Key::RIGHT;
+			table['D'] = Key::LEFT;
+			table['H'] = Key::HOME;
+			table['F'] = Key::END;
+			table['P'] = Key::F1;
+			table['Q'] = Key::F2;
+			table['R'] = Key::F3; // only reachable through SS3; CSI R is a cursor position report
+			table['S'] = Key::F4;
+			return table;
+		}() };
+
+		char _seq[CAPACITY]{};
+		std::size_t _seq_size{ 0ull };
+		bool _seq_overflow{ false };
+		unsigned _string_flushes{ 0u };	///< @brief The number of times flush() was called while the current string was pending.
+		State _state{ State::GROUND };
+		char32_t _utf8_codepoint{ 0 };
+		unsigned char _utf8_remaining{ 0u };
+		std::size_t _paste_match{ 0ull };	///< @brief The number of bytes of PASTE_END_SEQUENCE that have been matched.
+		std::size_t _paste_held{ 0ull };	///< @brief The number of matched bytes that came from a previous call to feed(), & haven't been emitted.
+
+		void begin_sequence(const State state, const char c) noexcept
+		{
+			_state = state;
+			_seq_size = 0ull;
+			_seq_overflow = false;
+			_string_flushes = 0u;
+			append(c);
+		}
+		void append(const char c) noexcept
+		{
+			if (_seq_size < CAPACITY)
+				_seq[_seq_size++] = c;
+			else _seq_overflow = true;
+		}
+		std::string_view sequence() const noexcept { return{ _seq, _seq_size }; }
+
+		static constexpr KeyModifier modifier_param(const unsigned param) noexcept
+		{
+			return param <= 1u ? KeyModifier::NONE : static_cast<KeyModifier>((param - 1u) & 0xFu);
+		}
+
+		template<typename Handler>
+		static void emit_key(Handler& handler, const Key key, const KeyModifier modifiers = KeyModifier::NONE, const char32_t codepoint = 0)
+		{
+			InputEvent e;
+			e.type = InputEventType::KEY;
+			e.key = key;
+			e.modifiers = modifiers;
+			e.codepoint = codepoint;
+			handler(static_cast<const InputEvent&>(e));
+		}
+		template<typename Handler>
+		static void emit(Handler& handler, const InputEventType type, const std::string_view& data = {})
+		{
+			InputEvent e;
+			e.type = type;
+			e.data = data;
+			handler(static_cast<const InputEvent&>(e));
+		}
+
+		/// @brief	Decode a single byte received outside of any escape sequence.
+		template<typename Handler>
+		void ground(Handler& handler, const char c, KeyModifier modifiers = KeyModifier::NONE)
+		{
+			const auto uc{ static_cast<unsigned char>(c) };
+			if (_utf8_remaining != 0u) {
+				if ((uc & 0xC0u) == 0x80u) {
+					_utf8_codepoint = (_utf8_codepoint << 6u) | (uc & 0x3Fu);
+					if (--_utf8_remaining == 0u)
+						emit_key(handler, Key::CHARACTER, modifiers, _utf8_codepoint);
+					return;
+				}
+				_utf8_remaining = 0u; // truncated character
+				emit_key(handler, Key::CHARACTER, modifiers, U'\uFFFD');
+			}
+			if (uc >= 0x80u) {
+				if ((uc & 0xE0u) == 0xC0u)
+					_utf8_codepoint = uc & 0x1Fu, _utf8_remaining = 1u;
+				else if ((uc & 0xF0u) == 0xE0u)
+					_utf8_codepoint = uc & 0x0Fu, _utf8_remaining = 2u;
+				else if ((uc & 0xF8u) == 0xF0u)
+					_utf8_codepoint = uc & 0x07u, _utf8_remaining = 3u;
+				else emit_key(handler, Key::CHARACTER, modifiers, U'\uFFFD');
+				return;
+			}
+			switch (uc) {
+			case '\r': [[fallthrough]];
+			case '\n':
+				return emit_key(handler, Key::ENTER, modifiers);
+			case '\t':
+				return emit_key(handler, Key::TAB, modifiers);
+			case 0x7Fu:
+				return emit_key(handler, Key::BACKSPACE, modifiers);
+			case 0x08u:
+				return emit_key(handler, Key::BACKSPACE, modifiers | KeyModifier::CTRL);
+			case 0x00u:
+				return emit_key(handler, Key::CHARACTER, modifiers | KeyModifier::CTRL, U' ');
+			default:
+				if (uc < 0x20u) // CTRL+letter & friends
+					return emit_key(handler, Key::CHARACTER, modifiers | KeyModifier::CTRL, static_cast<char32_t>(uc + 0x60u));
+				return emit_key(handler, Key::CHARACTER, modifiers, static_cast<char32_t>(uc));
+			}
+		}
+
+		/// @brief	Decode a complete CSI sequence that is stored in the sequence buffer.
+		template<typename Handler>
+		void dispatch_csi(Handler& handler)
+		{
+			const auto seq{ sequence() };
+			const char final{ seq.back() };
+			// parse the prefix, parameters, & intermediates
+			char prefix{ '\0' }, intermediate{ '\0' };
+			unsigned params[MAX_PARAMS]{};
+			std::size_t count{ 0ull };
+			bool has_digits{ false };
+			for (std::size_t i{ 2ull }; i + 1ull < seq.size(); ++i) {
+				const char c{ seq[i] };
+				if (c >= '0' && c <= '9') {
+					if (count < MAX_PARAMS)
+						params[count] = params[count] * 10u + static_cast<unsigned>(c - '0');
+					has_digits = true;
+				}
+				else if (c == ';' || c == ':') {
+					++count;
+					has_digits = false;
+				}
+				else if (c >= '<' && c <= '?' && i == 2ull)
+					prefix = c;
+				else intermediate = c;
+			}
+			if (has_digits || count != 0ull)
+				++count;
+
+			if (prefix == '<' && (final == 'M' || final == 'm') && count >= 3ull) { // SGR 1006 mouse report
+				InputEvent e;
+				e.type = InputEventType::MOUSE;
+				const auto code{ params[0] };
+				if ((code & 4u) != 0u) e.modifiers |= KeyModifier::SHIFT;
+				if ((code & 8u) != 0u) e.modifiers |= KeyModifier::ALT;
+				if ((code & 16u) != 0u) e.modifiers |= KeyModifier::CTRL;
+				if ((code & 64u) != 0u)
+					e.button = static_cast<MouseButton>(static_cast<unsigned char>(MouseButton::WHEEL_UP) + (code & 3u));
+				else if ((code & 3u) != 3u)
+					e.button = static_cast<MouseButton>(static_cast<unsigned char>(MouseButton::LEFT) + (code & 3u));
+				e.action = (code & 32u) != 0u ? MouseAction::MOVE : (final == 'M' ? MouseAction::PRESS : MouseAction::RELEASE);
+				e.x = params[1];
+				e.y = params[2];
+				return handler(static_cast<const InputEvent&>(e));
+			}
+			if (prefix == '\0' && intermediate == '\0') {
+				const auto modifiers{ count >= 2ull ? modifier_param(params[1]) : KeyModifier::NONE };
+				switch (final) {
+				case '~':
+					if (params[0] == 200u)
+						return begin_paste(handler);
+					if (params[0] < TILDE_KEYS.size() && TILDE_KEYS[params[0]] != Key::NONE)
+						return emit_key(handler, TILDE_KEYS[params[0]], modifiers);
+					break;
+				case 'Z':
+					return emit_key(handler, Key::TAB, KeyModifier::SHIFT);
+				case 'I':
+					if (count == 0ull)
+						return emit(handler, InputEventType::FOCUS_IN);
+					break;
+				case 'O':
+					if (count == 0ull)
+						return emit(handler, InputEventType::FOCUS_OUT);
+					break;
+				case 'R': // cursor position report; xterm's CSI 1;<mod>R for F3 is indistinguishable, so replies take priority
+				case 't': // window size report
+					return emit(handler, InputEventType::REPLY, seq);
+				default:
+					if (const auto uc{ static_cast<unsigned char>(final) }; uc < FINAL_KEYS.size() && FINAL_KEYS[uc] != Key::NONE)
+						return emit_key(handler, FINAL_KEYS[uc], modifiers);
+					break;
+				}
+			}
+			else if ((prefix == '?' || prefix == '>') && final == 'c') // DA1 & DA2
+				return emit(handler, InputEventType::REPLY, seq);
+			else if (intermediate == '$' && final == 'y') // DECRPM
+				return emit(handler, InputEventType::REPLY, seq);
+			emit(handler, InputEventType::UNKNOWN, seq);
+		}
+
+		template<typename Handler>
+		void begin_paste(Handler& handler)
+		{
+			_state = State::PASTE;
+			_paste_match = 0ull;
+			_paste_held = 0ull;
+			emit(handler, InputEventType::PASTE_BEGIN);
+		}
+
+		/**
+		 * @brief	Consume pasted text from the input until the end of the paste, emitting it as PASTE events that refer directly to the input.
+		 * @returns	std::size_t	The number of bytes that were consumed.
+		 */
+		template<typename Handler>
+		std::size_t paste(Handler& handler, const std::string_view& input)
+		{
+			std::size_t chunk_start{ 0ull };
+			for (std::size_t i{ 0ull }; i < input.size(); ++i) {
+				const char c{ input[i] };
+				if (c != PASTE_END_SEQUENCE[_paste_match] && _paste_match != 0ull) { // the partial match was ordinary text
+					if (_paste_held != 0ull)
+						emit(handler, InputEventType::PASTE, PASTE_END_SEQUENCE.substr(0ull, _paste_held));
+					_paste_match = _paste_held = 0ull;
+				}
+				if (c == PASTE_END_SEQUENCE[_paste_match] && ++_paste_match == PASTE_END_SEQUENCE.size()) {
+					if (const auto end{ i + 1ull - (_paste_match - _paste_held) }; end > chunk_start)
+						emit(handler, InputEventType::PASTE, input.substr(chunk_start, end - chunk_start));
+					_paste_match = _paste_held = 0ull;
+					_state = State::GROUND;
+					emit(handler, InputEventType::PASTE_END);
+					return i + 1ull;
+				}
+			}
+			// hold back a partial match of the end sequence until the next call
+			if (const auto end{ input.size() - (_paste_match - _paste_held) }; end > chunk_start)
+				emit(handler, InputEventType::PASTE, input.substr(chunk_start, end - chunk_start));
+			_paste_held = _paste_match;
+			return input.size();
+		}
+
+	public:
+		/**
+		 * @brief			Decode the next piece of input.
+		 * @param input		Bytes received from the terminal.
+		 * @param handler	Callable that receives each decoded event as a const InputEvent&, in order.
+		 */
+		template<typename Handler>
+		void feed(std::string_view input, Handler&& handler)
+		{
+			for (std::size_t i{ 0ull }; i < input.size(); ++i) {
+				if (_state == State::PASTE) {
+					i += paste(handler, input.substr(i)) - 1ull;
+					continue;
+				}
+				const char c{ input[i] };
+				const auto uc{ static_cast<unsigned char>(c) };
+				switch (_state) {
+				case State::GROUND:
+					if (c == '\x1b') {
+						if (_utf8_remaining != 0u) { // truncated character
+							_utf8_remaining = 0u;
+							emit_key(handler, Key::CHARACTER, KeyModifier::NONE, U'\uFFFD');
+						}
+						begin_sequence(State::ESCAPE, c);
+					}
+					else ground(handler, c);
+					break;
+				case State::ESCAPE:
+					switch (c) {
+					case '[':
+						_state = State::CSI;
+						append(c);
+						break;
+					case 'O':
+						_state = State::SS3;
+						append(c);
+						break;
+					case ']': [[fallthrough]];
+					case 'P':
+						_state = State::STRING;
+						append(c);
+						break;
+					case '\x1b': // the previous escape was a key press
+						emit_key(handler, Key::ESCAPE);
+						break;
+					default: // ALT+key
+						_state = State::GROUND;
+						if (uc >= 0x80u) {
+							emit_key(handler, Key::ESCAPE);
+							ground(handler, c);
+						}
+						else ground(handler, c, KeyModifier::ALT);
+						break;
+					}
+					break;
+				case State::CSI:
+					append(c);
+					if (uc >= 0x40u && uc <= 0x7Eu) {
+						_state = State::GROUND;
+						if (!_seq_overflow)
+							dispatch_csi(handler);
+					}
+					else if (uc < 0x20u || uc > 0x7Eu) { // malformed; resynchronize
+						if (c == '\x1b')
+							begin_sequence(State::ESCAPE, c);
+						else {
+							_state = State::GROUND;
+							ground(handler, c);
+						}
+					}
+					break;
+				case State::SS3:
+					_state = State::GROUND;
+					append(c);
+					if (uc < FINAL_KEYS.size() && FINAL_KEYS[uc] != Key::NONE)
+						emit_key(handler, FINAL_KEYS[uc]);
+					else emit(handler, InputEventType::UNKNOWN, sequence());
+					break;
+				case State::STRING:
+					append(c);
+					if (c == '\a') {
+						_state = State::GROUND;
+						if (!_seq_overflow)
+							emit(handler, InputEventType::REPLY, sequence());
+					}
+					else if (c == '\x1b')
+						_state = State::STRING_ESCAPE;
+					break;
+				case State::STRING_ESCAPE:
+					append(c);
+					if (c == '\\') {
+						_state = State::GROUND;
+						if (!_seq_overflow)
+							emit(handler, InputEventType::REPLY, sequence());
+					}
+					else _state = State::STRING; // not a string terminator
+					break;
+				case State::PASTE:
+					break;
+				}
+			}
+		}
+
+		/**
+		 * @brief			Emit whatever is left of an incomplete sequence as key presses. Call this once input has been idle for a short time (typically 25-50ms).
+		 *\n				A pending ESC becomes Key::ESCAPE, & "ESC [", "ESC O", "ESC ]", or "ESC P" become ALT+'[', ALT+'O', ALT+']', or ALT+'P'.
+		 *\n				Partial strings are left alone, so that a slow reply can still complete, unless they remain unterminated for MAX_STRING_FLUSHES calls;
+		 *\n				they are then decoded as an ALT key followed by typed input. Pastes are always left alone.
+		 * @param handler	Callable that receives each decoded event as a const InputEvent&.
+		 */
+		template<typename Handler>
+		void flush(Handler&& handler)
+		{
+			switch (_state) {
+			case State::ESCAPE:
+				_state = State::GROUND;
+				emit_key(handler, Key::ESCAPE);
+				break;
+			case State::CSI: [[fallthrough]];
+			case State::SS3:
+				if (_seq_size == 2ull) {
+					_state = State::GROUND;
+					emit_key(handler, Key::CHARACTER, KeyModifier::ALT, static_cast<char32_t>(_seq[1]));
+				}
+				break;
+			case State::STRING: [[fallthrough]];
+			case State::STRING_ESCAPE:
+				if (_seq_size == 2ull || ++_string_flushes >= MAX_STRING_FLUSHES) {
+					// the introducer was ALT+']' or ALT+'P', & the rest was typed
+					char rest[CAPACITY];
+					const auto rest_size{ _seq_size - 2ull };
+					std::copy(_seq + 2ull, _seq + _seq_size, rest);
+					_state = State::GROUND;
+					emit_key(handler, Key::CHARACTER, KeyModifier::ALT, static_cast<char32_t>(_seq[1]));
+					if (rest_size != 0ull) {
+						feed({ rest, rest_size }, handler);
+						flush(handler);
+					}
+				}
+				break;
+			default:
+				break;
+			}
+		}
+
+		/// @brief	Check if the decoder is in the middle of an escape sequence, in which case flush() may emit events.
+		bool pending() const noexcept { return _state != State::GROUND && _state != State::PASTE; }
+		/// @brief	Check if the decoder is inside of a bracketed paste.
+		bool in_paste() const noexcept { return _state == State::PASTE; }
+		/// @brief	Discard all partially decoded input.
+		void reset() noexcept
+		{
+			_state = State::GROUND;
+			_seq_size = 0ull;
+			_seq_overflow = false;
+			_utf8_remaining = 0u;
+			_paste_match = _paste_held = 0ull;
+		}
+	};
+}
@@ -0,0 +1,293 @@
+/**
+ * @file	InputRouter.hpp
+ * @author	radj307
+ * @brief	Contains the InputRouter class, which takes sole ownership of the terminal's input & separates query replies from user input.
+ */
+#pragma once
+#include <sysarch.h>
+#include <query-engine.hpp>
+#include <InputDecoder.hpp>
+#include <make_exception.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+#ifndef OS_WIN
+#include <fcntl.h>
+#endif
+
+namespace sys::term {
+	/**
+	 * @struct	RoutedEvent
+	 * @brief	An input event that was queued by an InputRouter. Owns a copy of the event's data.
+	 */
+	struct RoutedEvent {
+		/// @brief	The event. Its data member is always empty; use data instead.
+		InputEvent event;
+		/// @brief	The pasted text of a PASTE event, or the entire sequence of a REPLY or UNKNOWN event.
+		std::string data;
+	};
+
+	/**
+	 * @class	InputRouter
+	 * @brief	Single owner of the terminal's input, which demultiplexes it on a background thread.
+	 *\n		Replies to outstanding queries are handed to the thread that is waiting for them; everything else is decoded into the event queue.
+	 *\n		While an InputRouter exists, query() & every function built on it (getCursorPosition, getDeviceAttributes, ...) are routed through it,
+	 *\n		so queries can run while the application is interactive, from any number of threads at once.
+	 *\n		Only one InputRouter may exist at a time, & it must outlive every query that it receives.
+	 */
+	class InputRouter : public QueryRouter {
+		/// @brief	A thread that is waiting for a query reply.
+		struct Waiter {
+			const predicate_type& accept;
+			std::optional<std::string> reply{ std::nullopt };
+		};
+
+		const std::chrono::microseconds _escape_timeout;
+		const RawMode _raw;
+		InputDecoder _decoder;
+		ReplyParser _reply_parser;
+		mutable std::mutex _mutex;
+		std::condition_variable _replied;
+		std::condition_variable _queued;
+		std::vector<Waiter*> _waiters;	///< @brief Outstanding queries, oldest first.
+		std::deque<RoutedEvent> _events;
+		bool _stop{ false };
+	#ifndef OS_WIN
+		int _wake_pipe[2]{ -1, -1 };
+	#endif
+		std::thread _reader;
+
+		/// @brief	Offer a reply to the outstanding queries, oldest first. Must be called with the mutex held.
+		bool claim_reply(const std::string_view& sequence)
+		{
+			_reply_parser.reset();
+			for (const char c : sequence)
+				_reply_parser.feed(c);
+			if (!_reply_parser.complete())
+				return false;
+			for (auto* waiter : _waiters) {
+				if (!waiter->reply.has_value() && waiter->accept(_reply_parser)) {
+					waiter->reply = std::string{ sequence };
+					_replied.notify_all();
+					return true;
+				}
+			}
+			return false;
+		}
+
+		/// @brief	Route a decoded event. Must be called with the mutex held.
+		void route(const InputEvent& e)
+		{
+			if (e.type == InputEventType::REPLY && claim_reply(e.data))
+				return;
+			if (e.type == InputEventType::PASTE && !_events.empty() && _events.back().event.type == InputEventType::PASTE) {
+				_events.back().data.append(e.data); // merge paste chunks that haven't been retrieved yet
+				return;
+			}
+			RoutedEvent& queued{ _events.emplace_back(RoutedEvent{ e, std::string{ e.data } }) };
+			queued.event.data = {};
+			_queued.notify_all();
+		}
+
+		void decode(const std::string_view& input)
+		{
+			std::scoped_lock lock(_mutex);
+			if (input.empty())
+				_decoder.flush([this](const InputEvent& e) { route(e); });
+			else _decoder.feed(input, [this](const InputEvent& e) { route(e); });
+		}
+
+		void run()
+		{
+			char buffer[4096];
+			for (;;) {
+				const bool pending{ [this] { std::scoped_lock lock(_mutex); return _decoder.pending(); }() };
+			#ifdef OS_WIN
+				const auto deadline{ std::chrono::steady_clock::now() + _escape_timeout };
+				bool ready{ false };
+				while (!(ready = _kbhit()) && (!pending || std::chrono::steady_clock::now() < deadline)) {
+					if (std::scoped_lock lock(_mutex); _stop)
+						return;
+					std::this_thread::sleep_for(std::chrono::milliseconds{ 1 });
+				}
+				if (std::scoped_lock lock(_mutex); _stop)
+					return;
+				if (!ready) {
+					decode({});
+					continue;
+				}
+			#else
+				pollfd fds[2]{ { STDIN_FILENO, POLLIN, 0 }, { _wake_pipe[0], POLLIN, 0 } };
+				const int timeout_ms{ pending ? static_cast<int>((_escape_timeout.count() + 999ll) / 1000ll) : -1 };
+				const auto result{ poll(fds, 2, timeout_ms) };
+				if (result < 0) {
+					if (errno == EINTR)
+						continue;
+					return;
+				}
+				if ((fds[1].revents & POLLIN) != 0)
+					return;
+				if (result == 0) { // input went idle in the middle of a sequence
+					decode({});
+					continue;
+				}
+				if ((fds[0].revents & (POLLHUP | POLLERR | POLLNVAL)) != 0 && (fds[0].revents & POLLIN) == 0)
+					return;
+			#endif
+				const auto count{ _internal::read_available(buffer, sizeof(buffer)) };
+			#ifndef OS_WIN
+				if (count == 0ull) // poll reported input, so this is the end of the input
+					return;
+			#endif
+				if (count != 0ull)
+					decode({ buffer, count });
+			}
+		}
+
+	public:
+		/**
+		 * @brief					Constructor. Switches the terminal into raw mode, starts the reader thread, & registers the router with setQueryRouter().
+		 *\n						When the input isn't a terminal, no reader thread is started & the input is left untouched; see active().
+		 * @param escape_timeout	How long input must be idle before a lone ESC is reported as Key::ESCAPE.
+		 * @throws					std::exception	Another query router is already registered.
+		 */
+		explicit InputRouter(const std::chrono::microseconds& escape_timeout = std::chrono::microseconds{ 25'000 }) noexcept(false) : _escape_timeout{ escape_timeout }
+		{
+			QueryRouter* expected{ nullptr };
+			if (!_internal::query_router.compare_exchange_strong(expected, this, std::memory_order_acq_rel))
+				throw make_exception("InputRouter():\tAnother query router is already registered!");
+		#ifndef OS_WIN
+			if (pipe(_wake_pipe) != 0) {
+				setQueryRouter(nullptr);
+				throw make_exception("InputRouter():\tFailed to create the wake pipe!");
+			}
+			fcntl(_wake_pipe[1], F_SETFL, O_NONBLOCK);
+		#endif
+			if (_raw.active())
+				_reader = std::thread{ &InputRouter::run, this };
+		}
+		InputRouter(const InputRouter&) = delete;
+		InputRouter& operator=(const InputRouter&) = delete;
+		/// @brief	Destructor. Stops the reader thread, unregisters the router, & restores the terminal mode.
+		~InputRouter() override
+		{
+			{
+				std::scoped_lock lock(_mutex);
+				_stop = true;
+			}
+		#ifndef OS_WIN
+			const char c{ 0 };
+			[[maybe_unused]] const auto written{ ::write(_wake_pipe[1], &c, 1ull) };
+		#endif
+			if (_reader.joinable())
+				_reader.join();
+			QueryRouter* self{ this };
+			_internal::query_router.compare_exchange_strong(self, nullptr, std::memory_order_acq_rel);
+		#ifndef OS_WIN
+			close(_wake_pipe[0]);
+			close(_wake_pipe[1]);
+		#endif
+			_queued.notify_all();
+		}
+
+		/// @brief	Check if the terminal's input could be switched into raw mode. When this is false, no input will be received.
+		bool active() const noexcept { return _raw.active(); }
+
+		/**
+		 * @brief			Send a query request & wait for its reply, while other input continues to be routed to the event queue.
+		 *\n				Replies are offered to outstanding queries in the order that the queries were sent; replies that no query accepts are queued as REPLY events.
+		 * @param request	The query escape sequence to send.
+		 * @param accept	Predicate that receives each unclaimed reply, & returns true when it is the reply to this request.
+		 * @param timeout	The maximum amount of time to wait for the reply.
+		 * @returns			std::optional<std::string>	The complete reply, or std::nullopt when the terminal didn't answer in time.
+		 */
+		std::optional<std::string> route_query(std::string_view request, predicate_type accept, std::chrono::microseconds timeout) override
+		{
+			return std::move(route_batch(request, { std::move(accept) }, timeout, true).front());
+		}
+		/**
+		 * @brief					Send several query requests in a single write, & wait for all of their replies within one deadline.
+		 * @param requests			The concatenated query escape sequences.
+		 * @param accept			One predicate per query, in the order that the requests were written.
+		 * @param timeout			The maximum amount of time to wait for all of the replies.
+		 * @param last_is_sentinel	When true, stop waiting as soon as the last query is answered.
+		 * @returns					std::vector<std::optional<std::string>>	One reply per predicate, or std::nullopt for queries that weren't answered.
+		 */
+		std::vector<std::optional<std::string>> route_batch(std::string_view requests, const std::vector<predicate_type>& accept, std::chrono::microseconds timeout, bool last_is_sentinel) override
+		{
+			std::vector<Waiter> waiters;
+			waiters.reserve(accept.size());
+			for (const auto& predicate : accept)
+				waiters.emplace_back(Waiter{ predicate });
+			std::vector<std::optional<std::string>> replies(accept.size());
+			if (!_raw.active() || waiters.empty())
+				return replies;
+			const auto is_done{ [&] {
+				if (last_is_sentinel && waiters.back().reply.has_value())
+					return true;
+				return std::all_of(waiters.begin(), waiters.end(), [](const Waiter& w) { return w.reply.has_value(); });
+			} };
+
+			std::unique_lock lock(_mutex);
+			for (auto& waiter : waiters) // registered before the requests are written, so the replies can't arrive first
+				_waiters.emplace_back(&waiter);
+			lock.unlock();
+			const bool written{ _internal::write_query_request(requests) };
+			lock.lock();
+			if (written)
+				_replied.wait_until(lock, std::chrono::steady_clock::now() + timeout, is_done);
+			std::erase_if(_waiters, [&waiters](const Waiter* w) { return w >= waiters.data() && w < waiters.data() + waiters.size(); });
+			for (std::size_t i{ 0ull }; i < waiters.size(); ++i)
+				replies[i] = std::move(waiters[i].reply);
+			return replies;
+		}
+
+		/**
+		 * @brief	Retrieve the oldest queued event without waiting.
+		 * @returns	std::optional<RoutedEvent>	std::nullopt when the queue is empty.
+		 */
+		std::optional<RoutedEvent> try_next_event()
+		{
+			std::scoped_lock lock(_mutex);
+			if (_events.empty())
+				return std::nullopt;
+			auto e{ std::move(_events.front()) };
+			_events.pop_front();
+			return e;
+		}
+		/**
+		 * @brief			Retrieve the oldest queued event, waiting for one to arrive if the queue is empty.
+		 * @param timeout	The maximum amount of time to wait.
+		 * @returns			std::optional<RoutedEvent>	std::nullopt when no event arrived in time.
+		 */
+		std::optional<RoutedEvent> next_event(const std::chrono::microseconds& timeout)
+		{
+			std::unique_lock lock(_mutex);
+			if (!_queued.wait_until(lock, std::chrono::steady_clock::now() + timeout, [this] { return !_events.empty() || _stop; }) || _events.empty())
+				return std::nullopt;
+			auto e{ std::move(_events.front()) };
+			_events.pop_front();
+			return e;
+		}
+
+		/// @brief	Get the number of queued events.
+		std::size_t queued() const
+		{
+			std::scoped_lock lock(_mutex);
+			return _events.size();
+		}
+		/// @brief	Get the number of queries that are waiting for a reply.
+		std::size_t outstanding() const
+		{
+			std::scoped_lock lock(_mutex);
+			return _waiters.size();
+		}
+	};
+}
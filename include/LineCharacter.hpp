@@ -4,6 +4,7 @@
  * @brief	TermAPI Extension that adds the LineCharacter object, which wraps most of the DEC Line Drawing characters with friendlier names.
  */
 #pragma once
+#include <OutputWriter.hpp>
 #include <ostream>	// For std::ostream
 namespace sys::term {
 	/**
@@ -44,6 +45,10 @@ namespace sys::term {
 		{
 			return os << line._ch;
 		}
+		friend OutputWriter& operator<<(OutputWriter& w, const LineCharacter& line)
+		{
+			return w.append(static_cast<char>(line._ch));
+		}
 	};
 	/// ┘ Bottom-Right Corner Line
 	constexpr const LineCharacter LineCharacter::CORNER_BOTTOM_RIGHT{ '\x6a' };
@@ -0,0 +1,217 @@
+/**
+ * @file	LogPane.hpp
+ * @author	radj307
+ * @brief	Contains the LogPane class, which scrolls log output natively within a scrolling region above a pinned status footer.
+ */
+#pragma once
+#include <SequenceDefinitions.hpp>
+#include <CursorPlanner.hpp>
+#include <OutputWriter.hpp>
+#include <make_exception.hpp>
+
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace sys::term {
+	/**
+	 * @class	LogPane
+	 * @brief	Splits the screen into a log region & a status footer of one or more lines at the bottom.
+	 *\n		The log region is set as the terminal's scrolling region (DECSTBM), so log lines scroll natively without disturbing the footer,
+	 *\n		& footer lines are only redrawn when their contents change. Output is written one complete line at a time; all methods are thread-safe.
+	 *\n		A LogPane can be used as the output target of an xlog::xLog:
+	 *\n		`sys::term::LogPane pane{ rows, 1u }; xlog::xLog<sys::term::LogPane> log{ pane };`
+	 */
+	class LogPane {
+		mutable std::mutex _mutex;
+		OutputWriter _writer{ OutputWriter::STDOUT_FD, 4096ull };
+		unsigned _height;
+		std::vector<std::string> _footer;	///< @brief The current footer lines.
+		std::vector<std::string> _drawn;	///< @brief The footer lines as they were last drawn.
+		bool _drawn_valid{ false };
+		std::string _line;					///< @brief Log output that hasn't been terminated with a newline yet.
+		bool _open{ false };
+		std::size_t _footer_redraws{ 0ull };
+
+		/// @brief	Get the row of the first footer line, relative to the cursor origin.
+		unsigned footerTop() const noexcept { return CursorPlanner::origin() + _height - static_cast<unsigned>(_footer.size()); }
+
+		/// @brief	Set the scrolling region to the rows above the footer, without moving the cursor.
+		void setMargins()
+		{
+			_writer << SaveCursor() << setScrollMargins(CursorPlanner::origin(), footerTop() - 1u) << LoadCursor();
+		}
+
+		/// @brief	Draw the footer lines that changed since they were last drawn, or all of them when the drawn footer is unknown.
+		void drawFooter()
+		{
+			bool began{ false };
+			for (std::size_t i{ 0ull }; i < _footer.size(); ++i) {
+				if (_drawn_valid && _footer[i] == _drawn[i])
+					continue;
+				if (!began) {
+					// automatic wrapping is disabled so that an overlong footer line is clipped instead of scrolling the screen
+					_writer << SaveCursor() << setAutoWrap(false);
+					began = true;
+				}
+				_writer << setCursorPosition(CursorPlanner::origin(), footerTop() + static_cast<unsigned>(i)) << EraseInLine(EraseScope::ALL_TEXT) << _footer[i];
+				_drawn[i] = _footer[i];
+				++_footer_redraws;
+			}
+			if (began)
+				_writer << setAutoWrap(true) << LoadCursor(); // also restores the graphics rendition that was active before the footer was drawn
+			_drawn_valid = true;
+		}
+
+		/// @brief	Write every complete line of log output. When flush_partial is true, the unterminated remainder is written too.
+		void writeLines(const bool flush_partial)
+		{
+			const auto end{ flush_partial ? _line.size() : _line.rfind('\n') + 1ull };
+			if (end == 0ull || end > _line.size())
+				return;
+			_writer << std::string_view{ _line.data(), end };
+			_line.erase(0ull, end);
+		}
+
+	public:
+		/**
+		 * @brief				Constructor. Reserves space at the bottom of the screen for the footer & sets the scrolling region to the rows above it.
+		 *\n					Log output continues from the cursor's current position.
+		 * @param rows			The height of the terminal window, in rows.
+		 * @param footer_lines	The number of lines in the footer.
+		 * @throws				std::exception	There are no rows left over for the log region.
+		 */
+		LogPane(const unsigned& rows, const unsigned& footer_lines = 1u) noexcept(false) : _height{ rows }, _footer(footer_lines), _drawn(footer_lines)
+		{
+			if (footer_lines == 0u || footer_lines >= rows)
+				throw make_exception("LogPane():\tThe footer must have at least 1 line, & fewer lines than the window has rows!");
+			std::scoped_lock lock(_mutex);
+			// scroll the screen if necessary so that the footer doesn't cover existing output
+			_writer.append(static_cast<std::size_t>(footer_lines), '\n');
+			setMargins();
+			_writer << CursorUp(footer_lines);
+			drawFooter();
+			_writer.flush();
+			_open = true;
+		}
+		LogPane(const LogPane&) = delete;
+		LogPane& operator=(const LogPane&) = delete;
+		/// @brief	Destructor. Calls close().
+		~LogPane() { close(); }
+
+		/**
+		 * @brief	Write any remaining log output, reset the scrolling region, & move the cursor below the footer.
+		 *\n		The footer is left on the screen. Does nothing if the pane was already closed.
+		 */
+		void close()
+		{
+			std::scoped_lock lock(_mutex);
+			if (!_open)
+				return;
+			writeLines(true);
+			_writer << SaveCursor() << ResetScrollMargins() << LoadCursor() << setCursorPosition(CursorPlanner::origin(), CursorPlanner::origin() + _height - 1u) << '\n';
+			_writer.flush();
+			_open = false;
+		}
+
+		/// @brief	Check if the pane is still open.
+		bool isOpen() const
+		{
+			std::scoped_lock lock(_mutex);
+			return _open;
+		}
+
+		/**
+		 * @brief		Update the scrolling region & redraw the footer after the terminal window was resized.
+		 * @param rows	The new height of the terminal window, in rows. Must be greater than the number of footer lines.
+		 * @returns		bool	false when the window is too small for the footer or the pane was closed, otherwise true.
+		 */
+		bool resize(const unsigned& rows)
+		{
+			std::scoped_lock lock(_mutex);
+			if (!_open || rows <= _footer.size())
+				return false;
+			if (rows > _height) // erase the old footer, which is now inside the log region
+				_writer << SaveCursor() << setCursorPosition(CursorPlanner::origin(), footerTop()) << EraseInDisplay(EraseScope::CURSOR_TO_END) << LoadCursor();
+			_height = rows;
+			setMargins();
+			_drawn_valid = false;
+			drawFooter();
+			return _writer.flush();
+		}
+
+		/**
+		 * @brief		Set the contents of a footer line. The line is only redrawn when its contents changed.
+		 * @param index	The index of the footer line, where 0 is the topmost line.
+		 * @param text	The new contents of the line, which may include color & formatting sequences but not newlines.
+		 * @returns		bool	false when the index is out of range or the pane was closed, otherwise true.
+		 */
+		bool setFooter(const std::size_t& index, std::string text)
+		{
+			std::scoped_lock lock(_mutex);
+			if (!_open || index >= _footer.size())
+				return false;
+			if (text == _footer[index])
+				return true;
+			_footer[index] = std::move(text);
+			drawFooter();
+			return _writer.flush();
+		}
+		/**
+		 * @brief		Set the contents of every footer line at once. Only the lines that changed are redrawn.
+		 * @param lines	The new footer lines. Missing lines are cleared, & extra lines are ignored.
+		 * @returns		bool	false when the pane was closed, otherwise true.
+		 */
+		bool setFooter(const std::vector<std::string>& lines)
+		{
+			std::scoped_lock lock(_mutex);
+			if (!_open)
+				return false;
+			for (std::size_t i{ 0ull }; i < _footer.size(); ++i)
+				_footer[i] = i < lines.size() ? lines[i] : std::string{};
+			drawFooter();
+			return _writer.flush();
+		}
+
+		/// @brief	Get the number of lines in the footer.
+		std::size_t footerHeight() const noexcept { return _footer.size(); }
+		/// @brief	Get the number of times that a footer line was drawn.
+		std::size_t footerRedraws() const
+		{
+			std::scoped_lock lock(_mutex);
+			return _footer_redraws;
+		}
+
+		/**
+		 * @brief		Append text to the log region. Each complete line is written immediately; text after the last newline is held until it is terminated or flushed.
+		 *\n			After the pane is closed, text is written immediately.
+		 * @param text	Log output.
+		 * @returns		LogPane&
+		 */
+		LogPane& write(const std::string_view text)
+		{
+			std::scoped_lock lock(_mutex);
+			_line.append(text);
+			if (!_open || text.find('\n') != std::string_view::npos) {
+				writeLines(!_open); // once closed, output is passed straight through
+				_writer.flush();
+			}
+			return *this;
+		}
+		/// @brief	Write any log output that hasn't been terminated with a newline yet.
+		void flush()
+		{
+			std::scoped_lock lock(_mutex);
+			if (!_open)
+				return;
+			writeLines(true);
+			_writer.flush();
+		}
+
+		friend LogPane& operator<<(LogPane& pane, const std::string_view text) { return pane.write(text); }
+		friend LogPane& operator<<(LogPane& pane, const std::string& text) { return pane.write(text); }
+		friend LogPane& operator<<(LogPane& pane, const char* text) { return pane.write(std::string_view{ text }); }
+		friend LogPane& operator<<(LogPane& pane, const char ch) { return pane.write(std::string_view{ &ch, 1ull }); }
+	};
+}
@@ -2,11 +2,28 @@
 #include <Sequence.hpp>
 #include <ColorPalette.hpp>
 
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <vector>
+
 namespace sys::term {
 #ifndef TERMAPI_ENABLE_OLD_FUNCTIONS
 	namespace message_settings {
-		static bool useColorSequencesInMessages{ true };
-		static size_t maxMessageSizeIndent{ 8ull };
+		inline bool useColorSequencesInMessages{ true };
+		inline size_t maxMessageSizeIndent{ 8ull };
+		/// @brief	Incremented whenever a setting changes, which invalidates the prefixes cached by every Message.
+		inline std::atomic<unsigned> generation{ 0u };
+	}
+
+	/**
+	 * @brief	Invalidate the prefixes cached by every Message. Call this after assigning to a message_settings variable or to color::color_settings::colorDepth directly;
+	 *\n		setMessageColorEnabled(), setMessageIndent(), & color::setColorDepth() already do.
+	 */
+	inline void invalidateMessagePrefixes() noexcept
+	{
+		message_settings::generation.fetch_add(1u, std::memory_order_release);
 	}
 
 	/**
@@ -14,10 +31,23 @@ namespace sys::term {
 	 * @param enable	When true, sets the message_palette to active. Else, disables message colors.
 	 * @returns			bool
 	 */
-	inline constexpr bool setMessageColorEnabled(const bool& enable)
+	inline bool setMessageColorEnabled(const bool& enable)
 	{
 		const auto copy{ message_settings::useColorSequencesInMessages };
 		message_settings::useColorSequencesInMessages = enable;
+		invalidateMessagePrefixes();
+		return copy;
+	}
+	/**
+	 * @brief			Set the width that message prefixes are padded to.
+	 * @param indent	The new width.
+	 * @returns			size_t	The previous width.
+	 */
+	inline size_t setMessageIndent(const size_t& indent)
+	{
+		const auto copy{ message_settings::maxMessageSizeIndent };
+		message_settings::maxMessageSizeIndent = indent;
+		invalidateMessagePrefixes();
 		return copy;
 	}
 
@@ -29,23 +59,86 @@ namespace sys::term {
 		const std::string _message;
 		const color::setcolor _color;
 		const bool _use_indent;
-	public:
-		constexpr Message(const std::string& message_prefix, const color::setcolor& color, const bool& use_indent = true) : _message{ message_prefix }, _color{ color }, _use_indent{ use_indent } {}
 
-		std::string as_string() const
+		/// @brief	The prefix renderings for one combination of settings. Never modified after it is published.
+		struct Rendered {
+			bool use_color;
+			size_t indent;
+			color::ColorDepth depth;
+			std::string colored;	///< @brief The result of as_string().
+			std::string uncolored;	///< @brief The result of as_string_no_color().
+
+			bool matches(const bool use_color, const size_t indent, const color::ColorDepth depth) const noexcept { return this->use_color == use_color && this->indent == indent && this->depth == depth; }
+		};
+		mutable std::atomic<const Rendered*> _cache{ nullptr };
+		mutable std::atomic<unsigned> _cache_generation{ ~0u }; ///< @brief The settings generation that _cache was looked up for.
+		mutable std::mutex _render_mutex;
+		/// @brief	One rendering per combination of settings that was used. Returning to earlier settings reuses their rendering, so this only grows when new settings are used.
+		///			Renderings are never removed, because other threads may still be reading them.
+		mutable std::vector<std::unique_ptr<const Rendered>> _renderings;
+
+		/// @brief	Get the generation of the settings that affect prefixes. Changes whenever a message setting or the color depth changes.
+		static unsigned settings_generation() noexcept
 		{
-			if (message_settings::useColorSequencesInMessages)
-				return str::stringify(_color, _message, color::reset, _use_indent ? str::VIndent(message_settings::maxMessageSizeIndent, _message.size()) : str::VIndent(0ull));
-			return _message;
+			return message_settings::generation.load(std::memory_order_acquire) + color::color_settings::generation.load(std::memory_order_acquire);
 		}
-		std::string as_string_no_color() const
+
+		/**
+		 * @brief	Get the renderings for the current settings, rendering them if these settings weren't used before.
+		 *\n		While the settings generation is unchanged, the cached rendering is returned without reading the settings.
+		 */
+		const Rendered& rendered() const
 		{
-			return str::stringify(_message, _use_indent ? str::VIndent(message_settings::maxMessageSizeIndent, _message.size()) : str::VIndent(0ull));
+			if (_cache_generation.load(std::memory_order_acquire) == settings_generation())
+				return *_cache.load(std::memory_order_acquire);
+
+			std::scoped_lock lock(_render_mutex);
+			// the generation is read before the settings & under the lock, so a rendering is never published for an older generation than one already published
+			const auto generation{ settings_generation() };
+			const auto use_color{ message_settings::useColorSequencesInMessages };
+			const auto indent{ message_settings::maxMessageSizeIndent };
+			const auto depth{ color::getColorDepth() };
+			const auto it{ std::find_if(_renderings.begin(), _renderings.end(), [&](const auto& r) { return r->matches(use_color, indent, depth); }) };
+			const Rendered* r{ it != _renderings.end() ? it->get() : nullptr };
+			if (r == nullptr) {
+				const auto padding{ _use_indent ? str::VIndent(indent, _message.size()) : str::VIndent(0ull) };
+				r = _renderings.emplace_back(std::make_unique<const Rendered>(Rendered{
+					use_color,
+					indent,
+					depth,
+					use_color ? str::stringify(_color, _message, color::reset, padding) : _message,
+					str::stringify(_message, padding),
+				})).get();
+			}
+			_cache.store(r, std::memory_order_release);
+			_cache_generation.store(generation, std::memory_order_release);
+			return *r;
 		}
 
+	public:
+		constexpr Message(const std::string& message_prefix, const color::setcolor& color, const bool& use_indent = true) : _message{ message_prefix }, _color{ color }, _use_indent{ use_indent } {}
+		Message(const Message& o) : _message{ o._message }, _color{ o._color }, _use_indent{ o._use_indent } {}
+
+		/**
+		 * @brief			Get the cached prefix for the current settings. Only renders the prefix when the settings have changed.
+		 * @param use_color	When true, returns the same string as as_string(), otherwise returns the same string as as_string_no_color().
+		 * @returns			const std::string&	Remains valid for the lifetime of this Message.
+		 */
+		const std::string& prefix(const bool use_color = true) const
+		{
+			const auto& r{ rendered() };
+			return use_color ? r.colored : r.uncolored;
+		}
+
+		std::string as_string() const { return prefix(true); }
+		std::string as_string_no_color() const { return prefix(false); }
+
+		// Streams each part separately, so that a stream with rendition tracking sees the color & reset sequences.
 		friend std::ostream& operator<<(std::ostream& os, const Message& msg)
 		{
-			return os << msg.as_string();
+			if (message_settings::useColorSequencesInMessages)
+				return os << msg._color << msg._message << color::reset << (msg._use_indent ? str::VIndent(message_settings::maxMessageSizeIndent, msg._message.size()) : str::VIndent(0ull));
+			return os << msg._message;
 		}
 	};
 
@@ -0,0 +1,212 @@
+/**
+ * @file	MultiProgress.hpp
+ * @author	radj307
+ * @brief	Contains the MultiProgress widget, which draws a progress bar for each of any number of parallel jobs from a single renderer thread.
+ */
+#pragma once
+#include <SequenceDefinitions.hpp>
+#include <FrameTransaction.hpp>
+#include <OutputWriter.hpp>
+#include <setcolor.hpp>
+#include <color-values.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace sys::term {
+	/**
+	 * @class	MultiProgress
+	 * @brief	Draws one progress bar per line, starting at the cursor's line, & keeps the cursor on the line below the last bar.
+	 *\n		Workers only update the atomic counters of their Bar, which never locks or writes output, so bars can be updated from any number of threads at any rate.
+	 *\n		A single renderer thread samples every bar at a fixed interval & redraws only the bars whose displayed value changed, all in one write.
+	 *\n		Nothing else may write to the terminal while a MultiProgress is running.
+	 */
+	class MultiProgress {
+	public:
+		/**
+		 * @class	Bar
+		 * @brief	A single progress bar. Obtained from MultiProgress::addBar().
+		 */
+		class alignas(64) Bar {
+			friend class MultiProgress;
+
+			std::atomic<std::uint64_t> _value{ 0ull };
+			std::atomic<std::uint64_t> _total;
+			const std::string _label;
+			const color::setcolor _color;
+			// only accessed by the renderer thread:
+			bool _drawn{ false };
+			std::uint64_t _drawn_key{ 0ull };
+
+		public:
+			Bar(std::string label, const std::uint64_t total, color::setcolor color) : _total{ total }, _label{ std::move(label) }, _color{ std::move(color) } {}
+			Bar(const Bar&) = delete;
+			Bar& operator=(const Bar&) = delete;
+
+			/// @brief	Add to the progress value. Lock-free.
+			void add(const std::uint64_t n = 1ull) noexcept { _value.fetch_add(n, std::memory_order_relaxed); }
+			/// @brief	Set the progress value. Lock-free.
+			void set(const std::uint64_t value) noexcept { _value.store(value, std::memory_order_relaxed); }
+			/// @brief	Set the value that represents completion. When it is 0, the bar shows the value instead of a percentage. Lock-free.
+			void setTotal(const std::uint64_t total) noexcept { _total.store(total, std::memory_order_relaxed); }
+			/// @brief	Get the progress value.
+			std::uint64_t value() const noexcept { return _value.load(std::memory_order_relaxed); }
+			/// @brief	Get the value that represents completion.
+			std::uint64_t total() const noexcept { return _total.load(std::memory_order_relaxed); }
+		};
+
+	private:
+		const unsigned _width;
+		const std::chrono::microseconds _interval;
+		const bool _synchronized;
+		mutable std::mutex _mutex;
+		std::condition_variable _stop_requested;
+		std::vector<std::unique_ptr<Bar>> _bars;
+		std::size_t _lines{ 0ull };	///< @brief The number of bars that have a line on the screen.
+		std::size_t _label_width{ 0ull };
+		bool _stop{ false };
+		std::atomic<std::uint64_t> _frames{ 0ull }, _redraws{ 0ull };
+		std::thread _thread;
+
+		/// @brief	Get the number of filled cells & the percentage of a bar, packed into a single value that changes only when the displayed bar changes.
+		std::uint64_t displayKey(const std::uint64_t value, const std::uint64_t total) const noexcept
+		{
+			if (total == 0ull)
+				return value;
+			const auto clamped{ std::min(value, total) };
+			const auto filled{ static_cast<std::uint64_t>(static_cast<double>(clamped) / static_cast<double>(total) * _width) };
+			const auto percent{ static_cast<std::uint64_t>(static_cast<double>(clamped) / static_cast<double>(total) * 100.0) };
+			return (filled << 8u) | percent;
+		}
+
+		/// @brief	Append a bar's line, starting at the first column & erasing anything that was left over from its previous contents.
+		void drawBar(OutputWriter& w, const Bar& bar, const std::uint64_t value, const std::uint64_t total) const
+		{
+			w << bar._label;
+			w.append(_label_width - bar._label.size() + 1ull, ' ');
+			if (total == 0ull)
+				w << '[' << value << ']';
+			else {
+				const auto key{ displayKey(value, total) };
+				const auto filled{ static_cast<std::size_t>(key >> 8u) };
+				w << '[' << bar._color;
+				w.append(filled, '#');
+				w << SetGraphicsRendition(0);
+				w.append(_width - filled, '-');
+				w << "] " << static_cast<unsigned>(key & 0xFFull) << '%';
+			}
+			w << EraseInLine(EraseScope::CURSOR_TO_END);
+		}
+
+		/// @brief	Redraw every bar whose displayed value changed, & draw bars that were added since the last frame.
+		void renderFrame()
+		{
+			auto& writer{ getOutputWriter() };
+			std::scoped_lock lock(_mutex);
+			std::optional<FrameTransaction> frame;
+			std::size_t line{ _lines }; // the cursor is on the line below the last bar
+			for (std::size_t i{ 0ull }; i < _bars.size(); ++i) {
+				Bar& bar{ *_bars[i] };
+				const auto value{ bar.value() }, total{ bar.total() };
+				const auto key{ displayKey(value, total) };
+				if (bar._drawn && bar._drawn_key == key)
+					continue;
+				if (!frame.has_value())
+					frame.emplace(writer, _synchronized);
+				if (line > i)
+					writer << CursorPrevLine(static_cast<unsigned>(line - i));
+				else if (line < i)
+					writer << CursorNextLine(static_cast<unsigned>(i - line));
+				else writer << '\r'; // a new bar on the line below the last bar
+				drawBar(writer, bar, value, total);
+				line = i;
+				if (i >= _lines) { // give a new bar its own line
+					writer << '\n';
+					_lines = i + 1ull;
+					line = _lines;
+				}
+				bar._drawn = true;
+				bar._drawn_key = key;
+				_redraws.fetch_add(1ull, std::memory_order_relaxed);
+			}
+			if (!frame.has_value())
+				return;
+			if (line < _lines)
+				writer << CursorNextLine(static_cast<unsigned>(_lines - line));
+			frame->commit();
+			_frames.fetch_add(1ull, std::memory_order_relaxed);
+		}
+
+		void run()
+		{
+			std::unique_lock lock(_mutex);
+			while (!_stop_requested.wait_for(lock, _interval, [this] { return _stop; })) {
+				lock.unlock();
+				renderFrame();
+				lock.lock();
+			}
+			lock.unlock();
+			renderFrame(); // draw the final values
+		}
+
+	public:
+		/**
+		 * @brief				Constructor. Starts the renderer thread.
+		 * @param width			The number of cells in each bar.
+		 * @param interval		How often the bars are sampled & redrawn.
+		 * @param synchronized	When true, each frame is wrapped in a synchronized update. Pass isSynchronizedOutputSupported() to use it when the terminal supports it.
+		 */
+		explicit MultiProgress(const unsigned width = 40u, const std::chrono::microseconds& interval = std::chrono::milliseconds{ 50 }, const bool synchronized = false) : _width{ width }, _interval{ interval }, _synchronized{ synchronized }
+		{
+			_thread = std::thread{ &MultiProgress::run, this };
+		}
+		MultiProgress(const MultiProgress&) = delete;
+		MultiProgress& operator=(const MultiProgress&) = delete;
+		/// @brief	Destructor. Calls stop().
+		~MultiProgress() { stop(); }
+
+		/// @brief	Draw the final value of every bar & stop the renderer thread. The cursor is left on the line below the last bar.
+		void stop()
+		{
+			{
+				std::scoped_lock lock(_mutex);
+				_stop = true;
+			}
+			_stop_requested.notify_one();
+			if (_thread.joinable())
+				_thread.join();
+		}
+
+		/**
+		 * @brief		Add a bar below the existing bars. It appears in the next frame.
+		 * @param label	Text shown to the left of the bar. Labels are padded to the length of the longest label.
+		 * @param total	The value that represents completion. When it is 0, the bar shows the value instead of a percentage.
+		 * @param color	The color of the filled part of the bar.
+		 * @returns		Bar&	The bar, which remains valid until the MultiProgress is destroyed.
+		 */
+		Bar& addBar(std::string label, const std::uint64_t total, color::setcolor color = color::setcolor{ color::green })
+		{
+			std::scoped_lock lock(_mutex);
+			if (label.size() > _label_width) {
+				_label_width = label.size();
+				for (const auto& bar : _bars) // the bars that were already drawn have to be realigned
+					bar->_drawn = false;
+			}
+			return *_bars.emplace_back(std::make_unique<Bar>(std::move(label), total, std::move(color)));
+		}
+
+		/// @brief	Get the number of frames that were written.
+		std::uint64_t framesRendered() const noexcept { return _frames.load(std::memory_order_relaxed); }
+		/// @brief	Get the number of times that a bar was drawn.
+		std::uint64_t barsRedrawn() const noexcept { return _redraws.load(std::memory_order_relaxed); }
+	};
+}
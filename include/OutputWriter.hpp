@@ -0,0 +1,209 @@
+/**
+ * @file	OutputWriter.hpp
+ * @author	radj307
+ * @brief	Contains the OutputWriter class, which collects escape sequences & text in a single buffer and writes it to the terminal with one system call.
+ */
+#pragma once
+#include <sysarch.h>
+#include <csi-encode.hpp>
+
+#include <atomic>
+#include <cstdio>
+#include <string>
+#include <string_view>
+#ifdef OS_WIN
+#include <io.h>
+#else
+#include <cerrno>
+#include <unistd.h>
+#endif
+
+namespace sys::term {
+	/**
+	 * @struct	OutputObserver
+	 * @brief	Interface for objects that are notified of everything written to STDOUT by an OutputWriter, such as CursorTracker.
+	 */
+	struct OutputObserver {
+		virtual ~OutputObserver() noexcept = default;
+		/// @brief	Called with the contents of each flush, immediately before they are written.
+		virtual void observe_output(const std::string_view output) noexcept = 0;
+	};
+
+	namespace _internal {
+		inline std::atomic<OutputObserver*> stdout_observer{ nullptr };
+	}
+
+	/**
+	 * @brief			Set the observer that is notified of all output written to STDOUT by any OutputWriter.
+	 * @param observer	The new observer, or nullptr to remove it. It must remain valid until it is removed.
+	 * @returns			OutputObserver*	The previous observer.
+	 */
+	inline OutputObserver* setOutputObserver(OutputObserver* observer) noexcept
+	{
+		return _internal::stdout_observer.exchange(observer, std::memory_order_acq_rel);
+	}
+
+	/**
+	 * @class	OutputWriter
+	 * @brief	Growable output buffer that is committed to a file descriptor in a single write at an explicit flush point.
+	 *\n		Sequences, colors, & line drawing characters can all be appended directly with operator<<.
+	 *\n		When no batch is active, commit() flushes immediately, which mirrors the behaviour of printing each sequence directly.
+	 */
+	class OutputWriter {
+		std::string _buffer;
+		int _fd;
+		unsigned _batch_depth{ 0u };
+
+	public:
+		/// @brief	File descriptor of STDOUT.
+		static constexpr const int STDOUT_FD{ 1 };
+		/// @brief	Number of bytes reserved by default, enough for a full-screen update of an average terminal.
+		static constexpr const std::size_t DEFAULT_RESERVE{ 16384ull };
+
+		/**
+		 * @class	Batch
+		 * @brief	RAII scope that defers all commits until the outermost batch is destroyed, at which point the buffer is flushed.
+		 */
+		class Batch {
+			OutputWriter& _writer;
+		public:
+			Batch(OutputWriter& writer) : _writer{ writer } { ++_writer._batch_depth; }
+			Batch(const Batch&) = delete;
+			Batch& operator=(const Batch&) = delete;
+			~Batch()
+			{
+				if (--_writer._batch_depth == 0u)
+					_writer.flush();
+			}
+		};
+
+		/**
+		 * @brief			Constructor.
+		 * @param fd		The file descriptor that the buffer is written to when flushed.
+		 * @param reserve	The number of bytes to reserve for the buffer.
+		 */
+		OutputWriter(const int fd = STDOUT_FD, const std::size_t reserve = DEFAULT_RESERVE) : _fd{ fd } { _buffer.reserve(reserve); }
+		OutputWriter(const OutputWriter&) = delete;
+		OutputWriter& operator=(const OutputWriter&) = delete;
+		~OutputWriter() { flush(); }
+
+		/// @brief	Append a string to the buffer.
+		OutputWriter& append(const std::string_view str)
+		{
+			_buffer.append(str);
+			return *this;
+		}
+		/// @brief	Append a character to the buffer.
+		OutputWriter& append(const char ch)
+		{
+			_buffer.push_back(ch);
+			return *this;
+		}
+		/// @brief	Append a character to the buffer a given number of times.
+		OutputWriter& append(const std::size_t count, const char ch)
+		{
+			_buffer.append(count, ch);
+			return *this;
+		}
+
+		/// @brief	Append the decimal representation of an integral or enum value to the buffer, encoded in-place.
+		template<ANSI::_internal::sequence_number T>
+		OutputWriter& append(const T number)
+		{
+			const auto pos{ _buffer.size() };
+			_buffer.resize(pos + ANSI::max_param_length_v<T>);
+			_buffer.resize(static_cast<std::size_t>(ANSI::encode_param(_buffer.data() + pos, number) - _buffer.data()));
+			return *this;
+		}
+
+		friend OutputWriter& operator<<(OutputWriter& w, const std::string_view str) { return w.append(str); }
+		friend OutputWriter& operator<<(OutputWriter& w, const std::string& str) { return w.append(str); }
+		friend OutputWriter& operator<<(OutputWriter& w, const char* str) { return w.append(std::string_view{ str }); }
+		friend OutputWriter& operator<<(OutputWriter& w, const char ch) { return w.append(ch); }
+		template<ANSI::_internal::sequence_number T>
+		friend OutputWriter& operator<<(OutputWriter& w, const T number) { return w.append(number); }
+
+		/// @brief	Retrieve a view of the buffered, unwritten output.
+		std::string_view view() const noexcept { return _buffer; }
+		/// @brief	Retrieve the number of buffered bytes.
+		std::size_t size() const noexcept { return _buffer.size(); }
+		/// @brief	Check if the buffer is empty.
+		bool empty() const noexcept { return _buffer.empty(); }
+		/// @brief	Discard all buffered output without writing it.
+		void clear() noexcept { _buffer.clear(); }
+		/// @brief	Retrieve the file descriptor that this writer outputs to.
+		int fd() const noexcept { return _fd; }
+		/// @brief	Check if a batch is currently deferring commits.
+		bool isBatching() const noexcept { return _batch_depth != 0u; }
+
+		/**
+		 * @brief	Begin a batch. All commits are deferred until the returned object is destroyed.
+		 * @returns	Batch
+		 */
+		[[nodiscard]] Batch batch() { return Batch{ *this }; }
+
+		/**
+		 * @brief	Flush the buffer if no batch is active. Called by functors after appending to the writer.
+		 * @returns	bool	false when the write failed, otherwise true.
+		 */
+		bool commit()
+		{
+			return isBatching() || flush();
+		}
+
+		/**
+		 * @brief	Write the entire buffer to the file descriptor with a single system call, retrying only for partial writes & interrupts.
+		 *\n		The C stdio buffer for STDOUT is flushed first so that output from printf/std::cout retains its ordering.
+		 * @returns	bool	false when the write failed, otherwise true.
+		 */
+		bool flush()
+		{
+			if (_buffer.empty())
+				return true;
+			fflush(stdout);
+			if (_fd == STDOUT_FD)
+				if (auto* observer{ _internal::stdout_observer.load(std::memory_order_acquire) }; observer != nullptr)
+					observer->observe_output(_buffer);
+			const char* data{ _buffer.data() };
+			std::size_t remaining{ _buffer.size() };
+			bool success{ true };
+			while (remaining != 0ull) {
+			#ifdef OS_WIN
+				const auto count{ _write(_fd, data, static_cast<unsigned>(remaining)) };
+				if (count < 0) {
+					success = false;
+					break;
+				}
+			#else
+				const auto count{ ::write(_fd, data, remaining) };
+				if (count < 0) {
+					if (errno == EINTR)
+						continue;
+					success = false;
+					break;
+				}
+			#endif
+				data += count;
+				remaining -= static_cast<std::size_t>(count);
+			}
+			_buffer.clear();
+			return success;
+		}
+	};
+
+	/**
+	 * @brief	Retrieve the calling thread's STDOUT writer, which is used by the operator() method of all sequence functors.
+	 * @returns	OutputWriter&
+	 */
+	inline OutputWriter& getOutputWriter()
+	{
+		thread_local OutputWriter writer{ OutputWriter::STDOUT_FD };
+		return writer;
+	}
+
+	/**
+	 * @brief	Begin a batch on the calling thread's STDOUT writer, so that every sequence printed with operator() within the scope is written at once.
+	 * @returns	OutputWriter::Batch
+	 */
+	[[nodiscard]] inline OutputWriter::Batch beginBatch() { return getOutputWriter().batch(); }
+}
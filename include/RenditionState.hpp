@@ -0,0 +1,288 @@
+/**
+ * @file	RenditionState.hpp
+ * @author	radj307
+ * @brief	Contains the RenditionState class, which tracks the graphics rendition of an output stream so that only attribute changes are emitted.
+ */
+#pragma once
+#include <Sequence.hpp>
+#include <color-sequence-table.hpp>
+
+#include <ostream>
+#include <string_view>
+
+namespace color {
+	/**
+	 * @class	RenditionState
+	 * @brief	Tracks the foreground color, background color, & format flags that are currently active on an output stream.
+	 *\n		Requested changes are compared against the tracked state; redundant changes are skipped & the remaining ones are merged into a single SGR sequence.
+	 *\n		Tracking is enabled per-stream with track() or the track_rendition manipulator. Every Sequence/FixedSequence inserted into a tracked stream is parsed to keep the state in sync.
+	 *\n		Escape sequences inserted as raw strings bypass the tracker, and should be followed by a call to invalidate().
+	 */
+	class RenditionState : public ANSI::SequenceObserver {
+	public:
+		/// @brief	Color value indicating that the color is unknown, or that it should not be changed.
+		static constexpr const short UNKNOWN{ -2 };
+		/// @brief	Color value indicating the terminal's default color.
+		static constexpr const short DEFAULT{ -1 };
+		/// @brief	Flag bit for bold text. Matches FormatFlag::BOLD.
+		static constexpr const unsigned char BOLD{ 1u };
+		/// @brief	Flag bit for inverted colors. Matches FormatFlag::INVERT.
+		static constexpr const unsigned char INVERT{ 4u };
+		/// @brief	Flag bit for underlined text. Matches FormatFlag::UNDERLINE.
+		static constexpr const unsigned char UNDERLINE{ 16u };
+		/// @brief	Mask of all flag bits.
+		static constexpr const unsigned char ALL_FLAGS{ BOLD | INVERT | UNDERLINE };
+
+		/// @brief	Sequence type returned by transition(). Large enough to change every attribute at once.
+		using sequence_type = ANSI::FixedSequence<48ull>;
+
+	private:
+		short _foreground{ UNKNOWN }, _background{ UNKNOWN };
+		unsigned char _flags{ 0u }, _known_flags{ 0u };
+
+		/// @brief	Apply a single SGR parameter list, such as "38;5;1;4", to the tracked state.
+		void applyParameters(const std::string_view params) noexcept
+		{
+			if (params.empty()) {
+				reset();
+				return;
+			}
+			unsigned values[16]{};
+			std::size_t count{ 0ull };
+			for (std::size_t pos{ 0ull }; pos <= params.size(); ++pos) {
+				if (pos == params.size() || params[pos] == ';') {
+					if (++count == std::size(values)) {
+						invalidate();
+						return;
+					}
+				}
+				else if (params[pos] >= '0' && params[pos] <= '9')
+					values[count] = values[count] * 10u + static_cast<unsigned>(params[pos] - '0');
+				else {
+					invalidate();
+					return;
+				}
+			}
+			for (std::size_t i{ 0ull }; i < count; ++i) {
+				switch (values[i]) {
+				case 0u:
+					reset();
+					break;
+				case 1u: setFlags(BOLD, true); break;
+				case 22u: setFlags(BOLD, false); break;
+				case 4u: setFlags(UNDERLINE, true); break;
+				case 24u: setFlags(UNDERLINE, false); break;
+				case 7u: setFlags(INVERT, true); break;
+				case 27u: setFlags(INVERT, false); break;
+				case 39u: _foreground = DEFAULT; break;
+				case 49u: _background = DEFAULT; break;
+				case 30u: case 31u: case 32u: case 33u: case 34u: case 35u: case 36u: case 37u:
+					_foreground = static_cast<short>(values[i] - 30u);
+					break;
+				case 90u: case 91u: case 92u: case 93u: case 94u: case 95u: case 96u: case 97u:
+					_foreground = static_cast<short>(values[i] - 90u + 8u);
+					break;
+				case 40u: case 41u: case 42u: case 43u: case 44u: case 45u: case 46u: case 47u:
+					_background = static_cast<short>(values[i] - 40u);
+					break;
+				case 100u: case 101u: case 102u: case 103u: case 104u: case 105u: case 106u: case 107u:
+					_background = static_cast<short>(values[i] - 100u + 8u);
+					break;
+				case 38u: [[fallthrough]];
+				case 48u:
+					if (i + 2ull < count && values[i + 1ull] == 5u) {
+						(values[i] == 38u ? _foreground : _background) = static_cast<short>(values[i + 2ull]);
+						i += 2ull;
+						break;
+					}
+					if (i + 4ull < count && values[i + 1ull] == 2u) { // 24-bit colors aren't tracked, so the layer becomes unknown
+						(values[i] == 38u ? _foreground : _background) = UNKNOWN;
+						i += 4ull;
+						break;
+					}
+					[[fallthrough]];
+				default:
+					invalidate();
+					return;
+				}
+			}
+		}
+
+		void setFlags(const unsigned char mask, const bool state) noexcept
+		{
+			_known_flags |= mask;
+			if (state)
+				_flags |= mask;
+			else _flags &= static_cast<unsigned char>(~mask);
+		}
+
+		static void streamEvent(std::ios_base::event ev, std::ios_base& stream, int index)
+		{
+			auto*& ptr{ stream.pword(index) };
+			if (ptr == nullptr)
+				return;
+			if (ev == std::ios_base::erase_event) {
+				delete static_cast<RenditionState*>(static_cast<ANSI::SequenceObserver*>(ptr));
+				ptr = nullptr;
+			}
+			else if (ev == std::ios_base::copyfmt_event) // the pointer was copied from another stream, which still owns it
+				ptr = static_cast<ANSI::SequenceObserver*>(new RenditionState(*static_cast<RenditionState*>(static_cast<ANSI::SequenceObserver*>(ptr))));
+		}
+
+	public:
+		RenditionState() = default;
+
+		/// @brief	Get the tracked foreground color. Returns UNKNOWN when it isn't known.
+		short foreground() const noexcept { return _foreground; }
+		/// @brief	Get the tracked background color. Returns UNKNOWN when it isn't known.
+		short background() const noexcept { return _background; }
+		/// @brief	Get the tracked format flags. Only the bits in knownFlags() are meaningful.
+		unsigned char flags() const noexcept { return _flags; }
+		/// @brief	Get the mask of format flags whose state is known.
+		unsigned char knownFlags() const noexcept { return _known_flags; }
+
+		/// @brief	Forget everything, so that the next transition emits every requested attribute.
+		void invalidate() noexcept
+		{
+			_foreground = UNKNOWN;
+			_background = UNKNOWN;
+			_flags = 0u;
+			_known_flags = 0u;
+		}
+		/// @brief	Set the state to the terminal defaults, as if "ESC[0m" had been emitted.
+		void reset() noexcept
+		{
+			_foreground = DEFAULT;
+			_background = DEFAULT;
+			_flags = 0u;
+			_known_flags = ALL_FLAGS;
+		}
+
+		/**
+		 * @brief				Update the tracked state from one or more escape sequences. Non-SGR sequences are ignored; SGR sequences with unsupported parameters invalidate the state.
+		 * @param seq			Any number of concatenated escape sequences.
+		 */
+		void observe(const std::string_view seq) noexcept override
+		{
+			for (std::size_t pos{ seq.find(ANSI::ESC) }; pos != std::string_view::npos; pos = seq.find(ANSI::ESC, pos + 1ull)) {
+				if (pos + 1ull >= seq.size() || seq[pos + 1ull] != ANSI::CSI)
+					continue;
+				const auto params_begin{ pos + 2ull };
+				auto end{ params_begin };
+				while (end < seq.size() && ((seq[end] >= '0' && seq[end] <= '9') || seq[end] == ';' || seq[end] == '?'))
+					++end;
+				if (end < seq.size() && seq[end] == 'm')
+					applyParameters(seq.substr(params_begin, end - params_begin));
+			}
+		}
+
+		/**
+		 * @brief				Build the shortest single SGR sequence that changes the tracked state to the requested one, and update the tracked state.
+		 * @param foreground	The requested foreground color, DEFAULT, or UNKNOWN to leave it unchanged.
+		 * @param background	The requested background color, DEFAULT, or UNKNOWN to leave it unchanged.
+		 * @param enable		Flags to enable.
+		 * @param disable		Flags to disable.
+		 * @param basic_colors	When true, colors 0-15 are set with the 16-color parameters (30-37, 90-97 / 40-47, 100-107) instead of 38;5;n / 48;5;n.
+		 * @returns				sequence_type	An empty sequence when nothing needs to change.
+		 */
+		sequence_type transition(const short foreground, const short background, const unsigned char enable = 0u, const unsigned char disable = 0u, const bool basic_colors = false) noexcept
+		{
+			sequence_type seq;
+			const auto add{ [&seq](const auto&... parts) {
+				seq.append(seq.empty() ? std::string_view{ "\x1b[" } : std::string_view{ ";" });
+				(seq.append(parts), ...);
+			} };
+			if (foreground != UNKNOWN && foreground != _foreground) {
+				if (foreground == DEFAULT)
+					add("39");
+				else if (basic_colors && foreground >= 0 && foreground <= 15)
+					add(basic_color_parameters(static_cast<unsigned char>(foreground), true));
+				else if (foreground >= 0 && foreground <= 255)
+					add(color_parameters(static_cast<unsigned char>(foreground), true));
+				else add(ANSI::FORE, ';', foreground);
+				_foreground = foreground;
+			}
+			if (background != UNKNOWN && background != _background) {
+				if (background == DEFAULT)
+					add("49");
+				else if (basic_colors && background >= 0 && background <= 15)
+					add(basic_color_parameters(static_cast<unsigned char>(background), false));
+				else if (background >= 0 && background <= 255)
+					add(color_parameters(static_cast<unsigned char>(background), false));
+				else add(ANSI::BACK, ';', background);
+				_background = background;
+			}
+			constexpr const struct { unsigned char mask; const char* on; const char* off; } codes[]{
+				{ BOLD, "1", "22" },
+				{ UNDERLINE, "4", "24" },
+				{ INVERT, "7", "27" },
+			};
+			for (const auto& [mask, on, off] : codes) {
+				const bool known{ (_known_flags & mask) != 0 }, active{ (_flags & mask) != 0 };
+				if ((enable & mask) != 0 && !(known && active)) {
+					add(on);
+					setFlags(mask, true);
+				}
+				else if ((disable & mask) != 0 && !(known && !active)) {
+					add(off);
+					setFlags(mask, false);
+				}
+			}
+			if (!seq.empty())
+				seq.append(ANSI::END);
+			return seq;
+		}
+
+		/// @brief	Retrieve the RenditionState attached to a stream, or nullptr if the stream isn't tracked.
+		static RenditionState* get(std::ios_base& stream) noexcept
+		{
+			return dynamic_cast<RenditionState*>(ANSI::SequenceObserver::get(stream));
+		}
+		/**
+		 * @brief			Enable rendition tracking for a stream. The state starts out unknown. The state is owned by the stream.
+		 * @param stream	The stream to track.
+		 * @returns			RenditionState&
+		 */
+		static RenditionState& track(std::ios_base& stream)
+		{
+			if (auto* state{ get(stream) }; state != nullptr)
+				return *state;
+			auto* state{ new RenditionState() };
+			stream.pword(index()) = static_cast<ANSI::SequenceObserver*>(state);
+			if (auto& registered{ stream.iword(index()) }; registered == 0l) { // callbacks can't be unregistered, so only register once per stream
+				stream.register_callback(&RenditionState::streamEvent, index());
+				registered = 1l;
+			}
+			return *state;
+		}
+		/// @brief	Disable rendition tracking for a stream.
+		static void untrack(std::ios_base& stream)
+		{
+			if (auto* state{ get(stream) }; state != nullptr) {
+				stream.pword(index()) = nullptr;
+				delete state;
+			}
+		}
+	};
+
+	/**
+	 * @brief		Output stream manipulator that enables rendition tracking for the stream. Example: std::cout << color::track_rendition;
+	 * @param os	Target output stream
+	 * @returns		std::ostream&
+	 */
+	inline std::ostream& track_rendition(std::ostream& os)
+	{
+		RenditionState::track(os);
+		return os;
+	}
+	/**
+	 * @brief		Output stream manipulator that disables rendition tracking for the stream.
+	 * @param os	Target output stream
+	 * @returns		std::ostream&
+	 */
+	inline std::ostream& untrack_rendition(std::ostream& os)
+	{
+		RenditionState::untrack(os);
+		return os;
+	}
+}
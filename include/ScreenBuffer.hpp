@@ -0,0 +1,464 @@
+/**
+ * @file	ScreenBuffer.hpp
+ * @author	radj307
+ * @brief	Contains the ScreenBuffer cell grid & the ScreenRenderer, which draws a ScreenBuffer by emitting only the cells that changed since the last frame.
+ */
+#pragma once
+#include <SequenceDefinitions.hpp>
+#include <CursorPlanner.hpp>
+#include <OutputWriter.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <string_view>
+#include <vector>
+
+namespace sys::term {
+	/**
+	 * @struct	CellStyle
+	 * @brief	The graphics rendition of a single cell.
+	 */
+	struct CellStyle {
+		/// @brief	Value used by the color members to indicate the terminal's default color.
+		static constexpr const short DEFAULT_COLOR{ -1 };
+		/// @brief	Flag bit for bold text.
+		static constexpr const unsigned char BOLD{ 1u };
+		/// @brief	Flag bit for inverted foreground & background colors.
+		static constexpr const unsigned char INVERT{ 4u };
+		/// @brief	Flag bit for underlined text.
+		static constexpr const unsigned char UNDERLINE{ 16u };
+
+		/// @brief	256-color foreground color index, or DEFAULT_COLOR.
+		short foreground{ DEFAULT_COLOR };
+		/// @brief	256-color background color index, or DEFAULT_COLOR.
+		short background{ DEFAULT_COLOR };
+		/// @brief	Any combination of BOLD, INVERT, & UNDERLINE.
+		unsigned char flags{ 0u };
+
+		constexpr bool operator==(const CellStyle&) const = default;
+	};
+
+	/**
+	 * @struct	Cell
+	 * @brief	A single character position in a ScreenBuffer. Every glyph is assumed to occupy exactly one column.
+	 */
+	struct Cell {
+		char32_t glyph{ U' ' };
+		CellStyle style{};
+
+		constexpr bool operator==(const Cell&) const = default;
+	};
+
+	namespace _internal {
+		/// @brief	Append a unicode codepoint to an output writer as UTF-8.
+		inline void append_utf8(OutputWriter& w, const char32_t ch)
+		{
+			if (ch < 0x80)
+				w.append(static_cast<char>(ch));
+			else if (ch < 0x800) {
+				w.append(static_cast<char>(0xC0 | (ch >> 6)));
+				w.append(static_cast<char>(0x80 | (ch & 0x3F)));
+			}
+			else if (ch < 0x10000) {
+				w.append(static_cast<char>(0xE0 | (ch >> 12)));
+				w.append(static_cast<char>(0x80 | ((ch >> 6) & 0x3F)));
+				w.append(static_cast<char>(0x80 | (ch & 0x3F)));
+			}
+			else {
+				w.append(static_cast<char>(0xF0 | (ch >> 18)));
+				w.append(static_cast<char>(0x80 | ((ch >> 12) & 0x3F)));
+				w.append(static_cast<char>(0x80 | ((ch >> 6) & 0x3F)));
+				w.append(static_cast<char>(0x80 | (ch & 0x3F)));
+			}
+		}
+		/**
+		 * @brief		Decode the next codepoint from a UTF-8 string, advancing pos past it. Invalid bytes are returned as U+FFFD.
+		 * @param str	The UTF-8 string.
+		 * @param pos	The index of the first byte of the codepoint. Receives the index of the next codepoint.
+		 * @returns		char32_t
+		 */
+		inline char32_t decode_utf8(const std::string_view str, std::size_t& pos) noexcept
+		{
+			const auto lead{ static_cast<unsigned char>(str[pos++]) };
+			if (lead < 0x80)
+				return lead;
+			std::size_t extra;
+			char32_t ch;
+			if ((lead & 0xE0) == 0xC0) { extra = 1ull; ch = lead & 0x1F; }
+			else if ((lead & 0xF0) == 0xE0) { extra = 2ull; ch = lead & 0x0F; }
+			else if ((lead & 0xF8) == 0xF0) { extra = 3ull; ch = lead & 0x07; }
+			else return U'\uFFFD';
+			for (; extra != 0ull; --extra) {
+				if (pos >= str.size() || (static_cast<unsigned char>(str[pos]) & 0xC0) != 0x80)
+					return U'\uFFFD';
+				ch = (ch << 6) | (static_cast<unsigned char>(str[pos++]) & 0x3F);
+			}
+			return ch;
+		}
+	}
+
+	/**
+	 * @class	ScreenBuffer
+	 * @brief	Off-screen grid of cells that can be drawn to the terminal with a ScreenRenderer.
+	 *\n		Coordinates are zero-based, and (0, 0) is the top-left corner.
+	 */
+	class ScreenBuffer {
+		unsigned _width, _height;
+		std::vector<Cell> _cells;
+
+	public:
+		/**
+		 * @brief			Constructor.
+		 * @param width		The number of columns in the grid.
+		 * @param height	The number of rows in the grid.
+		 */
+		ScreenBuffer(const unsigned width = 0u, const unsigned height = 0u) : _width{ width }, _height{ height }, _cells(static_cast<std::size_t>(width) * height) {}
+
+		unsigned width() const noexcept { return _width; }
+		unsigned height() const noexcept { return _height; }
+
+		/// @brief	Check if a position is within the bounds of the grid.
+		bool contains(const unsigned x, const unsigned y) const noexcept { return x < _width && y < _height; }
+
+		/// @brief	Resize the grid. All cells are reset to blank.
+		void resize(const unsigned width, const unsigned height)
+		{
+			_width = width;
+			_height = height;
+			_cells.assign(static_cast<std::size_t>(width) * height, Cell{});
+		}
+
+		/// @brief	Reset every cell to a blank space with the given style.
+		void clear(const CellStyle& style = {})
+		{
+			std::fill(_cells.begin(), _cells.end(), Cell{ U' ', style });
+		}
+
+		/// @brief	Retrieve the cell at a given position. The position must be within bounds.
+		Cell& at(const unsigned x, const unsigned y) { return _cells[static_cast<std::size_t>(y) * _width + x]; }
+		/// @brief	Retrieve the cell at a given position. The position must be within bounds.
+		const Cell& at(const unsigned x, const unsigned y) const { return _cells[static_cast<std::size_t>(y) * _width + x]; }
+
+		/// @brief	Retrieve a pointer to the first cell of a row. The row must be within bounds.
+		Cell* row(const unsigned y) { return _cells.data() + static_cast<std::size_t>(y) * _width; }
+		/// @brief	Retrieve a pointer to the first cell of a row. The row must be within bounds.
+		const Cell* row(const unsigned y) const { return _cells.data() + static_cast<std::size_t>(y) * _width; }
+
+		/**
+		 * @brief		Set a single cell. Positions outside of the grid are ignored.
+		 * @returns		bool	true when the position was within bounds.
+		 */
+		bool set(const unsigned x, const unsigned y, const char32_t glyph, const CellStyle& style = {})
+		{
+			if (!contains(x, y))
+				return false;
+			at(x, y) = Cell{ glyph, style };
+			return true;
+		}
+
+		/**
+		 * @brief		Write a UTF-8 string to a row, starting at the given position. Text that extends past the right edge is clipped.
+		 * @param x		Starting column.
+		 * @param y		Row.
+		 * @param text	UTF-8 encoded text. Control characters are written as-is and should be avoided.
+		 * @param style	The style to apply to every written cell.
+		 * @returns		unsigned	The number of cells that were written.
+		 */
+		unsigned write(unsigned x, const unsigned y, const std::string_view text, const CellStyle& style = {})
+		{
+			if (y >= _height)
+				return 0u;
+			const unsigned begin{ x };
+			for (std::size_t pos{ 0ull }; pos < text.size() && x < _width; ++x)
+				at(x, y) = Cell{ _internal::decode_utf8(text, pos), style };
+			return x - begin;
+		}
+
+		/// @brief	Fill a rectangle with the given glyph & style. The rectangle is clipped to the grid.
+		void fill(const unsigned x, const unsigned y, const unsigned width, const unsigned height, const char32_t glyph = U' ', const CellStyle& style = {})
+		{
+			for (unsigned row{ y }; row < y + height && row < _height; ++row)
+				for (unsigned col{ x }; col < x + width && col < _width; ++col)
+					at(col, row) = Cell{ glyph, style };
+		}
+	};
+
+	/**
+	 * @class	ScreenRenderer
+	 * @brief	Draws ScreenBuffer frames to the terminal. Each frame is compared against the last frame that was presented, and only runs of changed cells are emitted.
+	 *\n		Blocks of rows that moved vertically are first moved with the terminal's scrolling region, so scrolling content only costs the newly exposed rows.
+	 */
+	class ScreenRenderer {
+		ScreenBuffer _front;
+		bool _valid{ false };
+		CursorPlanner _cursor;
+		CellStyle _style{};
+		bool _style_known{ false };
+		bool _scroll_enabled{ true };
+		std::size_t _scrolls{ 0ull }, _rows_scrolled{ 0ull };
+		// scratch space for scroll detection, kept between frames to avoid reallocating
+		std::vector<std::uint64_t> _front_hashes, _next_hashes;
+		std::vector<unsigned short> _lcs;
+
+		/// @brief	The maximum number of unchanged cells that may be rewritten instead of moving the cursor over them.
+		static constexpr const unsigned MAX_OVERWRITE{ 16u };
+		/// @brief	The approximate number of bytes needed to set the scrolling margins, scroll, & reset them.
+		static constexpr const unsigned SCROLL_COST{ 24u };
+		/// @brief	The maximum height of a frame that is searched for scrolled rows.
+		static constexpr const unsigned MAX_SCROLL_HEIGHT{ 512u };
+
+		/// @brief	Hash the cells of a row. (FNV-1a)
+		static std::uint64_t hashRow(const Cell* row, const unsigned width) noexcept
+		{
+			std::uint64_t hash{ 0xCBF29CE484222325ull };
+			const auto mix{ [&hash](const std::uint64_t v) { hash = (hash ^ v) * 0x100000001B3ull; } };
+			for (unsigned x{ 0u }; x < width; ++x) {
+				mix(static_cast<std::uint64_t>(row[x].glyph));
+				mix((static_cast<std::uint64_t>(static_cast<unsigned short>(row[x].style.foreground)) << 24u) | (static_cast<std::uint64_t>(static_cast<unsigned short>(row[x].style.background)) << 8u) | row[x].style.flags);
+			}
+			return hash;
+		}
+
+		/**
+		 * @brief			Move rows [top, bottom] of the last presented frame up (positive) or down (negative) by the given number of rows, blanking the rows that are exposed.
+		 *\n				This mirrors what the terminal does when the same region is scrolled.
+		 */
+		void shiftFront(const unsigned top, const unsigned bottom, const int distance)
+		{
+			const auto width{ static_cast<std::ptrdiff_t>(_front.width()) };
+			Cell* const first{ _front.row(top) };
+			Cell* const last{ _front.row(bottom) + width };
+			const auto cells{ static_cast<std::ptrdiff_t>(std::abs(distance)) * width };
+			if (distance > 0) {
+				std::move(first + cells, last, first);
+				std::fill(last - cells, last, Cell{});
+			}
+			else {
+				std::move_backward(first, last - cells, last);
+				std::fill(first, first + cells, Cell{});
+			}
+		}
+
+		/**
+		 * @brief		Find blocks of rows that moved vertically between the last presented frame & the next frame, & move them with the terminal's scrolling region.
+		 *\n			Rows are matched by hash with a longest common subsequence; consecutive matches with the same offset form a hunk.
+		 *\n			Each hunk that would save more bytes than it costs is moved, & the last presented frame is shifted the same way so that the residual diff stays correct.
+		 */
+		void scroll(const ScreenBuffer& next, OutputWriter& w)
+		{
+			const unsigned height{ next.height() }, width{ next.width() };
+			if (height < 2u || height > MAX_SCROLL_HEIGHT || width == 0u)
+				return;
+			_front_hashes.resize(height);
+			_next_hashes.resize(height);
+			for (unsigned y{ 0u }; y < height; ++y) {
+				_front_hashes[y] = hashRow(_front.row(y), width);
+				_next_hashes[y] = hashRow(next.row(y), width);
+			}
+			if (_front_hashes == _next_hashes)
+				return;
+
+			// _lcs[i * (height + 1) + j] is the length of the LCS of the front rows from i & the next rows from j
+			const std::size_t stride{ height + 1ull };
+			_lcs.assign(stride * stride, 0u);
+			for (unsigned i{ height }; i-- > 0u; ) {
+				for (unsigned j{ height }; j-- > 0u; ) {
+					_lcs[i * stride + j] = _front_hashes[i] == _next_hashes[j]
+						? static_cast<unsigned short>(_lcs[(i + 1u) * stride + j + 1u] + 1u)
+						: std::max(_lcs[(i + 1u) * stride + j], _lcs[i * stride + j + 1u]);
+				}
+			}
+
+			struct Hunk { unsigned from, to, count; };
+			std::vector<Hunk> hunks;
+			for (unsigned i{ 0u }, j{ 0u }; i < height && j < height; ) {
+				if (_front_hashes[i] == _next_hashes[j]) {
+					if (!hunks.empty() && hunks.back().from + hunks.back().count == i && hunks.back().to + hunks.back().count == j)
+						++hunks.back().count;
+					else hunks.push_back(Hunk{ i, j, 1u });
+					++i;
+					++j;
+				}
+				else if (_lcs[(i + 1u) * stride + j] >= _lcs[i * stride + j + 1u])
+					++i;
+				else ++j;
+			}
+			// only keep hunks that moved & that would otherwise cost more to redraw than to scroll
+			std::erase_if(hunks, [&](const Hunk& h) {
+				if (h.from == h.to)
+					return true;
+				unsigned changed{ 0u };
+				for (unsigned k{ 0u }; k < h.count; ++k)
+					if (_front_hashes[h.to + k] != _next_hashes[h.to + k])
+						++changed;
+				return static_cast<std::size_t>(changed) * width <= SCROLL_COST;
+			});
+			if (hunks.empty())
+				return;
+
+			applyStyle(w, CellStyle{}); // exposed rows are filled with the current background color
+			const auto move{ [&](const Hunk& h) {
+				const bool up{ h.from > h.to };
+				const unsigned distance{ up ? h.from - h.to : h.to - h.from };
+				const unsigned top{ up ? h.to : h.from };
+				const unsigned bottom{ (up ? h.from : h.to) + h.count - 1u };
+				w << setScrollMargins(top + CursorPlanner::origin(), bottom + CursorPlanner::origin());
+				w << (up ? ScrollUp(distance) : ScrollDown(distance));
+				shiftFront(top, bottom, up ? static_cast<int>(distance) : -static_cast<int>(distance));
+				++_scrolls;
+				_rows_scrolled += h.count;
+			} };
+			// hunks are ordered & never cross, so moving the upward hunks top to bottom & the downward hunks bottom to top never overwrites a hunk that hasn't moved yet
+			for (const auto& h : hunks)
+				if (h.from > h.to)
+					move(h);
+			for (auto it{ hunks.rbegin() }; it != hunks.rend(); ++it)
+				if (it->from < it->to)
+					move(*it);
+			w << ResetScrollMargins();
+			_cursor.setKnown(0u, 0u); // DECSTBM homes the cursor
+		}
+
+		/**
+		 * @brief		Move the cursor to a zero-based position using the shortest motion.
+		 *\n			When the unchanged cells between the cursor & the target are plain ASCII in the active rendition, rewriting them is also considered.
+		 * @param row	The row of the next frame that contains the target.
+		 */
+		void moveTo(OutputWriter& w, const Cell* row, const unsigned x, const unsigned y)
+		{
+			char overwrite[MAX_OVERWRITE];
+			std::size_t length{ 0ull };
+			if (_cursor.isKnown() && _style_known && _cursor.y() == y && _cursor.x() < x && x - _cursor.x() <= MAX_OVERWRITE) {
+				for (unsigned col{ _cursor.x() }; col < x; ++col) {
+					if (row[col].glyph < U' ' || row[col].glyph > U'~' || row[col].style != _style) {
+						length = 0ull;
+						break;
+					}
+					overwrite[length++] = static_cast<char>(row[col].glyph);
+				}
+			}
+			_cursor.moveTo(w, x, y, { overwrite, length });
+		}
+		/// @brief	Change the current graphics rendition, unless it is already active.
+		void applyStyle(OutputWriter& w, const CellStyle& style)
+		{
+			if (_style_known && _style == style)
+				return;
+			w << ESC << CSI << '0';
+			if (style.foreground != CellStyle::DEFAULT_COLOR)
+				w << ';' << FORE << ';' << style.foreground;
+			if (style.background != CellStyle::DEFAULT_COLOR)
+				w << ';' << BACK << ';' << style.background;
+			if ((style.flags & CellStyle::BOLD) != 0)
+				w << ";1";
+			if ((style.flags & CellStyle::UNDERLINE) != 0)
+				w << ";4";
+			if ((style.flags & CellStyle::INVERT) != 0)
+				w << ";7";
+			w << END;
+			_style = style;
+			_style_known = true;
+		}
+		/// @brief	Write a cell's glyph, advancing the tracked cursor position.
+		void putCell(OutputWriter& w, const Cell& cell)
+		{
+			applyStyle(w, cell.style);
+			_internal::append_utf8(w, cell.glyph);
+			_cursor.advance();
+			// the cursor doesn't advance past the last column, so its position is ambiguous until the next move.
+			if (_cursor.x() >= _front.width())
+				_cursor.invalidate();
+		}
+
+	public:
+		ScreenRenderer() = default;
+
+		/// @brief	Forget the last presented frame, forcing the next render to redraw the entire screen.
+		void invalidate() noexcept
+		{
+			_valid = false;
+			_cursor.invalidate();
+			_style_known = false;
+		}
+
+		/// @brief	Retrieve the last frame that was presented.
+		const ScreenBuffer& front() const noexcept { return _front; }
+		/// @brief	Retrieve the cursor planner, which exposes the number of bytes saved by optimized cursor motions.
+		const CursorPlanner& cursor() const noexcept { return _cursor; }
+		/// @brief	Enable or disable moving scrolled rows with the terminal's scrolling region instead of redrawing them. Enabled by default.
+		void setScrollOptimization(const bool enable) noexcept { _scroll_enabled = enable; }
+		/// @brief	Retrieve the number of scroll operations that were emitted.
+		std::size_t scrollCount() const noexcept { return _scrolls; }
+		/// @brief	Retrieve the number of rows that were moved by scrolling instead of being redrawn.
+		std::size_t rowsScrolled() const noexcept { return _rows_scrolled; }
+
+		/**
+		 * @brief		Append the sequences required to transform the last presented frame into the given frame.
+		 *\n			When the previous frame is unknown or has a different size, the screen is erased first.
+		 * @param next	The frame to present.
+		 * @param w		The writer to append to. It is not flushed.
+		 * @returns		std::size_t	The number of bytes that were appended.
+		 */
+		std::size_t render(const ScreenBuffer& next, OutputWriter& w)
+		{
+			const auto begin_size{ w.size() };
+			if (!_valid || _front.width() != next.width() || _front.height() != next.height()) {
+				_front.resize(next.width(), next.height());
+				_style_known = false;
+				applyStyle(w, CellStyle{});
+				w << EraseInDisplay(EraseScope::ALL_TEXT);
+				_valid = true;
+			}
+			else if (_scroll_enabled)
+				scroll(next, w);
+			for (unsigned y{ 0u }; y < next.height(); ++y) {
+				const Cell* const prev_row{ _front.row(y) };
+				const Cell* const next_row{ next.row(y) };
+				for (unsigned x{ 0u }; x < next.width(); ++x) {
+					if (prev_row[x] == next_row[x])
+						continue;
+					moveTo(w, next_row, x, y);
+					for (; x < next.width() && prev_row[x] != next_row[x]; ++x)
+						putCell(w, next_row[x]);
+				}
+			}
+			_front = next;
+			return w.size() - begin_size;
+		}
+
+		/**
+		 * @brief		Render a frame to the calling thread's STDOUT writer and flush it with a single write.
+		 * @param next	The frame to present.
+		 * @returns		std::size_t	The number of bytes that were written.
+		 */
+		std::size_t present(const ScreenBuffer& next)
+		{
+			auto& writer{ getOutputWriter() };
+			const auto count{ render(next, writer) };
+			writer.flush();
+			return count;
+		}
+	};
+
+	/**
+	 * @struct	AlternateScreen
+	 * @brief	RAII scope that switches to the alternate screen buffer & hides the cursor, then restores the main screen buffer when destroyed.
+	 */
+	struct AlternateScreen {
+		AlternateScreen()
+		{
+			auto& writer{ getOutputWriter() };
+			writer << setAlternateScreenBuffer() << HideCursor();
+			writer.commit();
+		}
+		AlternateScreen(const AlternateScreen&) = delete;
+		AlternateScreen& operator=(const AlternateScreen&) = delete;
+		~AlternateScreen()
+		{
+			auto& writer{ getOutputWriter() };
+			writer << SetGraphicsRendition(0) << ShowCursor() << setMainScreenBuffer();
+			writer.commit();
+		}
+	};
+}
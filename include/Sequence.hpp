@@ -1,8 +1,159 @@
 #pragma once
 #include <ANSIDefs.h>
-#include <cstdio>
+#include <OutputWriter.hpp>
+#include <concepts>
+#include <ios>
 #include <ostream>
+#include <string>
+#include <string_view>
+#include <type_traits>
 namespace ANSI {
+	/// @brief	Default capacity of a FixedSequence, in characters. Large enough for any CSI sequence with two 32-bit parameters.
+	inline constexpr const std::size_t SEQUENCE_CAPACITY{ 32ull };
+
+	/**
+	 * @struct	SequenceObserver
+	 * @brief	Interface for objects that are attached to an output stream and notified of every Sequence & FixedSequence inserted into it.
+	 *\n		Used by color::RenditionState to keep its tracked graphics rendition in sync with the stream.
+	 */
+	struct SequenceObserver {
+		virtual ~SequenceObserver() noexcept = default;
+		/// @brief	Called with the characters of each sequence inserted into the observed stream.
+		virtual void observe(const std::string_view seq) noexcept = 0;
+
+		/// @brief	Retrieve the std::ios_base::pword index used to attach observers to streams.
+		static int index() noexcept
+		{
+			static const int i{ std::ios_base::xalloc() };
+			return i;
+		}
+		/// @brief	Retrieve the observer attached to a stream, or nullptr if there isn't one.
+		static SequenceObserver* get(std::ios_base& stream) noexcept
+		{
+			return static_cast<SequenceObserver*>(stream.pword(index()));
+		}
+		/// @brief	Notify the observer attached to a stream, if there is one.
+		static void notify(std::ios_base& stream, const std::string_view seq) noexcept
+		{
+			if (auto* observer{ get(stream) }; observer != nullptr)
+				observer->observe(seq);
+		}
+	};
+
+	/**
+	 * @struct		FixedSequence
+	 * @brief		Fixed-capacity escape sequence that stores its characters inline, so that constructing one never allocates.
+	 *\n			Exposes the same methods of execution as Sequence:
+	 *\n			- operator<<	_Output Streams_
+	 *\n			- operator()	_Inline_
+	 *\n			Characters appended beyond the capacity are discarded.
+	 * @tparam Capacity	The maximum number of characters that this sequence can hold.
+	 */
+	template<std::size_t Capacity = SEQUENCE_CAPACITY>
+	struct FixedSequence {
+	private:
+		char _seq[Capacity]{};
+		std::size_t _len{ 0ull };
+
+	public:
+		constexpr FixedSequence() = default;
+
+		/// @brief	Append a single character to the sequence.
+		constexpr FixedSequence& append(const char ch) noexcept
+		{
+			if (_len < Capacity)
+				_seq[_len++] = ch;
+			return *this;
+		}
+		/// @brief	Append a single character to the sequence.
+		template<_internal::sequence_char T> requires (!std::same_as<T, char>)
+		constexpr FixedSequence& append(const T ch) noexcept
+		{
+			return append(static_cast<char>(ch));
+		}
+		/// @brief	Append a string to the sequence.
+		constexpr FixedSequence& append(const std::string_view str) noexcept
+		{
+			for (const auto& ch : str)
+				append(ch);
+			return *this;
+		}
+		/// @brief	Append a null-terminated string to the sequence.
+		constexpr FixedSequence& append(const char* str) noexcept
+		{
+			return append(std::string_view{ str });
+		}
+		/// @brief	Append the decimal representation of an integral or enum value to the sequence. Digits are encoded directly into the inline buffer.
+		template<_internal::sequence_number T>
+		constexpr FixedSequence& append(const T number) noexcept
+		{
+			if (Capacity - _len >= max_param_length_v<T>)
+				_len = static_cast<std::size_t>(encode_param(_seq + _len, number) - _seq);
+			else {
+				char digits[max_param_length_v<T>]{};
+				append(std::string_view{ digits, static_cast<std::size_t>(encode_param(digits, number) - digits) });
+			}
+			return *this;
+		}
+		/// @brief	Append the contents of another fixed sequence.
+		template<std::size_t N>
+		constexpr FixedSequence& append(const FixedSequence<N>& seq) noexcept
+		{
+			return append(seq.view());
+		}
+
+		/// @brief	Retrieve a pointer to the first character. The sequence is not null-terminated.
+		constexpr const char* data() const noexcept { return _seq; }
+		/// @brief	Retrieve the number of characters in the sequence.
+		constexpr std::size_t size() const noexcept { return _len; }
+		/// @brief	Retrieve the maximum number of characters that this sequence can hold.
+		static constexpr std::size_t capacity() noexcept { return Capacity; }
+		/// @brief	Check if the sequence is empty.
+		constexpr bool empty() const noexcept { return _len == 0ull; }
+		/// @brief	Retrieve a view of the escape sequence string.
+		constexpr std::string_view view() const noexcept { return{ _seq, _len }; }
+		constexpr operator std::string_view() const noexcept { return view(); }
+		/// @brief	Retrieve a copy of the escape sequence string.
+		operator const std::string() const { return as_string(); }
+		std::string as_string() const { return{ _seq, _len }; }
+
+		template<std::size_t N>
+		constexpr bool operator==(const FixedSequence<N>& o) const noexcept { return view() == o.view(); }
+
+		/// @brief Prints this sequence to STDOUT through the calling thread's OutputWriter.
+		void operator()() const noexcept
+		{
+			auto& writer{ sys::term::getOutputWriter() };
+			writer.append(view());
+			writer.commit();
+		}
+		/// @brief Prints this sequence to an output stream.
+		friend std::ostream& operator<<(std::ostream& os, const FixedSequence<Capacity>& seq)
+		{
+			SequenceObserver::notify(os, seq.view());
+			return os.write(seq._seq, static_cast<std::streamsize>(seq._len));
+		}
+		/// @brief Appends this sequence to an output writer.
+		friend sys::term::OutputWriter& operator<<(sys::term::OutputWriter& w, const FixedSequence<Capacity>& seq)
+		{
+			return w.append(seq.view());
+		}
+	};
+
+	/**
+	 * @brief				Build a FixedSequence from any number of characters, strings, & numbers without allocating.
+	 * @tparam Capacity		The capacity of the returned sequence.
+	 * @param ...parts		The components of the escape sequence, in order.
+	 * @returns				FixedSequence<Capacity>
+	 */
+	template<std::size_t Capacity = SEQUENCE_CAPACITY, typename... VT>
+	inline constexpr FixedSequence<Capacity> make_fixed_sequence(const VT&... parts) noexcept
+	{
+		FixedSequence<Capacity> seq;
+		(seq.append(parts), ...);
+		return seq;
+	}
+
 	/**
 	 * @struct Sequence
 	 * @brief	Virtual functor that exposes multiple methods of executing an ANSI escape sequence.
@@ -18,20 +169,29 @@ namespace ANSI {
 	public:
 		constexpr Sequence() = default;
 		constexpr Sequence(const std::string& seq) : _seq{ seq.c_str() } {}
+		template<std::size_t N>
+		constexpr Sequence(const FixedSequence<N>& seq) : _seq{ seq.data(), seq.size() } {}
 		constexpr ~Sequence() noexcept = default;
 		/// @brief Retrieve the escape sequence string.
 		constexpr operator const std::string() const { return _seq; }
 		constexpr std::string as_string() const { return _seq; }
-		/// @brief Prints this sequence to STDOUT
+		/// @brief Prints this sequence to STDOUT through the calling thread's OutputWriter.
 		void operator()() const noexcept
 		{
-			fflush(stdout);
-			printf(_seq.c_str());
+			auto& writer{ sys::term::getOutputWriter() };
+			writer.append(_seq);
+			writer.commit();
 		}
 		/// @brief Prints this sequence to STDOUT
 		friend std::ostream& operator<<(std::ostream& os, const Sequence& seq) noexcept
 		{
+			SequenceObserver::notify(os, seq._seq);
 			return os << seq._seq;
 		}
+		/// @brief Appends this sequence to an output writer.
+		friend sys::term::OutputWriter& operator<<(sys::term::OutputWriter& w, const Sequence& seq)
+		{
+			return w.append(seq._seq);
+		}
 	};
-}
\ No newline at end of file
+}
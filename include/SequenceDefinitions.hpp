@@ -1,7 +1,7 @@
 /**
  * @file SequenceDefinitions.hpp
  * @author radj307
- * @brief	Contains ANSI escape sequence functors derived from Sequence.
+ * @brief	Contains ANSI escape sequence functors that return allocation-free FixedSequence instances.
  *\n		Covers most/all of the virtual sequences documented by microsoft here:
  *\n		https://docs.microsoft.com/en-us/windows/console/console-virtual-terminal-sequences
  */
@@ -9,6 +9,7 @@
 #include <Sequence.hpp>
 #include <CursorOrigin.h>
 #include <TermAPIQuery.hpp>
+#include <make_exception.hpp>
 
 #define SEQUENCE_DEFINITIONS
 
@@ -18,133 +19,133 @@ namespace sys::term {
 	/**
 	 * @brief	Move the cursor up in the screen buffer.
 	 * @param n	Number of characters to move by.
-	 * @returns Sequence
+	 * @returns FixedSequence
 	 */
-	[[nodiscard]] inline Sequence CursorUp(const unsigned& n = 1u)
+	[[nodiscard]] inline constexpr FixedSequence<> CursorUp(const unsigned& n = 1u)
 	{
-		return Sequence(make_sequence(ESC, CSI, n, 'A'));
+		return make_fixed_sequence(ESC, CSI, n, 'A');
 	}
 	/**
 	 * @brief	Move the cursor down in the screen buffer.
 	 * @param n	Number of characters to move by.
-	 * @returns Sequence
+	 * @returns FixedSequence
 	 */
-	[[nodiscard]] inline Sequence CursorDown(const unsigned& n = 1u)
+	[[nodiscard]] inline constexpr FixedSequence<> CursorDown(const unsigned& n = 1u)
 	{
-		return Sequence(make_sequence(ESC, CSI, n, 'B'));
+		return make_fixed_sequence(ESC, CSI, n, 'B');
 	}
 	/**
 	 * @brief	Move the cursor forwards on the current line.
 	 * @param n	Number of characters to move by.
-	 * @returns Sequence
+	 * @returns FixedSequence
 	 */
-	[[nodiscard]] inline Sequence CursorForward(const unsigned& n = 1u)
+	[[nodiscard]] inline constexpr FixedSequence<> CursorForward(const unsigned& n = 1u)
 	{
-		return Sequence(make_sequence(ESC, CSI, n, 'C'));
+		return make_fixed_sequence(ESC, CSI, n, 'C');
 	}
 	/**
 	 * @brief	Move the cursor backwards on the current line.
 	 * @param n	Number of characters to move by.
-	 * @returns Sequence
+	 * @returns FixedSequence
 	 */
-	[[nodiscard]] inline Sequence CursorBackward(const unsigned& n = 1u)
+	[[nodiscard]] inline constexpr FixedSequence<> CursorBackward(const unsigned& n = 1u)
 	{
-		return Sequence(make_sequence(ESC, CSI, n, 'D'));
+		return make_fixed_sequence(ESC, CSI, n, 'D');
 	}
 	/**
 	 * @brief	Move the cursor to the beginning of one of the next lines.
 	 * @param n	Number of lines to move the cursor.
-	 * @returns Sequence
+	 * @returns FixedSequence
 	 */
-	[[nodiscard]] inline Sequence CursorNextLine(const unsigned& n = 1u)
+	[[nodiscard]] inline constexpr FixedSequence<> CursorNextLine(const unsigned& n = 1u)
 	{
-		return Sequence(make_sequence(ESC, CSI, n, 'E'));
+		return make_fixed_sequence(ESC, CSI, n, 'E');
 	}
 	/**
 	 * @brief	Move the cursor to the beginning of a previous line.
 	 * @param n	Number of lines to move the cursor.
-	 * @returns Sequence
+	 * @returns FixedSequence
 	 */
-	[[nodiscard]] inline Sequence CursorPrevLine(const unsigned& n = 1u)
+	[[nodiscard]] inline constexpr FixedSequence<> CursorPrevLine(const unsigned& n = 1u)
 	{
-		return Sequence(make_sequence(ESC, CSI, n, 'F'));
+		return make_fixed_sequence(ESC, CSI, n, 'F');
 	}
 	/**
 	 * @brief			Set the cursor's horizontal position to a specific column.
 	 * @param column	The character number to move the cursor to. The cursor will stay on the current line.
-	 * @returns			Sequence
+	 * @returns			FixedSequence
 	 */
-	[[nodiscard]] inline Sequence CursorHorizontalAbs(const unsigned& column)
+	[[nodiscard]] inline FixedSequence<> CursorHorizontalAbs(const unsigned& column)
 	{
-		return Sequence(make_sequence(ESC, CSI, !!_internal::CURSOR_MIN_AXIS + column, 'G'));
+		return make_fixed_sequence(ESC, CSI, !!_internal::CURSOR_MIN_AXIS + column, 'G');
 	}
 	/**
 	 * @brief			Set the cursor's vertical position to a specific row/line.
 	 * @param row		The line number to move the cursor to. The cursor will stay in the current column.
-	 * @returns			Sequence
+	 * @returns			FixedSequence
 	 */
-	[[nodiscard]] inline Sequence CursorVerticalAbs(const unsigned& row)
+	[[nodiscard]] inline FixedSequence<> CursorVerticalAbs(const unsigned& row)
 	{
-		return Sequence(make_sequence(ESC, CSI, !!_internal::CURSOR_MIN_AXIS + row, 'd'));
+		return make_fixed_sequence(ESC, CSI, !!_internal::CURSOR_MIN_AXIS + row, 'd');
 	}
 	/**
 	 * @brief Set the cursor's position to a given column and row.
 	 * @param x_column	- Horizontal position on the target line.
 	 * @param y_row		- Vertical position / the target line.
-	 * @returns Sequence
+	 * @returns FixedSequence
 	 */
-	[[nodiscard]] inline Sequence setCursorPosition(const unsigned& x_column, const unsigned& y_row)
+	[[nodiscard]] inline FixedSequence<> setCursorPosition(const unsigned& x_column, const unsigned& y_row)
 	{
-		return Sequence(make_sequence(ESC, CSI, !!_internal::CURSOR_MIN_AXIS + y_row, ';', !!_internal::CURSOR_MIN_AXIS + x_column, 'H'));
+		return make_fixed_sequence(ESC, CSI, !!_internal::CURSOR_MIN_AXIS + y_row, ';', !!_internal::CURSOR_MIN_AXIS + x_column, 'H');
 	}
 	/**
 	 * @brief Set the cursor's position to a given column and row.
 	 * @param pos	- Pair where the first element is the horizontal position, and the second is the vertical position.
-	 * @returns Sequence
+	 * @returns FixedSequence
 	 */
-	[[nodiscard]] inline Sequence setCursorPosition(const std::pair<unsigned, unsigned>& pos) { return setCursorPosition(pos.first, pos.second); }
+	[[nodiscard]] inline FixedSequence<> setCursorPosition(const std::pair<unsigned, unsigned>& pos) { return setCursorPosition(pos.first, pos.second); }
 	/**
 	 * @brief Save the cursor position. Can be recalled later with LoadCursor.
-	 * @returns Sequence
+	 * @returns FixedSequence
 	 */
-	[[nodiscard]] inline Sequence SaveCursor()
+	[[nodiscard]] inline constexpr FixedSequence<> SaveCursor()
 	{
-		return Sequence(make_sequence(ESC, '7'));
+		return make_fixed_sequence(ESC, '7');
 	}
 	/**
 	 * @brief Set the cursor's position to the last saved position with SaveCursor.
-	 * @returns Sequence
+	 * @returns FixedSequence
 	 */
-	[[nodiscard]] inline Sequence LoadCursor()
+	[[nodiscard]] inline constexpr FixedSequence<> LoadCursor()
 	{
-		return Sequence(make_sequence(ESC, '8'));
+		return make_fixed_sequence(ESC, '8');
 	}
 	/**
 	 * @brief			Set whether the cursor is visible or not.
 	 * @param visible	When true, the cursor is visible.
-	 * @returns			Sequence
+	 * @returns			FixedSequence
 	 */
-	[[nodiscard]] inline Sequence setCursorVisible(const bool& visible)
+	[[nodiscard]] inline constexpr FixedSequence<> setCursorVisible(const bool& visible)
 	{
-		return Sequence(make_sequence(ESC, CSI, CURSOR_VISIBLE, (visible ? ENABLE : DISABLE)));
+		return make_fixed_sequence(ESC, CSI, CURSOR_VISIBLE, (visible ? ENABLE : DISABLE));
 	}
 	/// @brief Hides the cursor.
-	[[nodiscard]] inline Sequence HideCursor() { return setCursorVisible(false); }
+	[[nodiscard]] inline constexpr FixedSequence<> HideCursor() { return setCursorVisible(false); }
 	/// @brief Shows the cursor.
-	[[nodiscard]] inline Sequence ShowCursor() { return setCursorVisible(true); }
+	[[nodiscard]] inline constexpr FixedSequence<> ShowCursor() { return setCursorVisible(true); }
 	/**
 	 * @brief			Set whether the cursor is blinking or not.
 	 * @param blinking	When true, the cursor is blinking.
-	 * @returns			Sequence
+	 * @returns			FixedSequence
 	 */
-	[[nodiscard]] inline Sequence setCursorBlink(const bool& blinking)
+	[[nodiscard]] inline constexpr FixedSequence<> setCursorBlink(const bool& blinking)
 	{
-		return Sequence(make_sequence(ESC, CSI, CURSOR_BLINK, (blinking ? ENABLE : DISABLE)));
+		return make_fixed_sequence(ESC, CSI, CURSOR_BLINK, (blinking ? ENABLE : DISABLE));
 	}
 	/// @brief Enables the cursor blink effect.
-	[[nodiscard]] inline Sequence EnableCursorBlink() { return setCursorBlink(true); }
+	[[nodiscard]] inline constexpr FixedSequence<> EnableCursorBlink() { return setCursorBlink(true); }
 	/// @brief Disables the cursor blink effect.
-	[[nodiscard]] inline Sequence DisableCursorBlink() { return setCursorBlink(false); }
+	[[nodiscard]] inline constexpr FixedSequence<> DisableCursorBlink() { return setCursorBlink(false); }
 
 	struct Cursor {
 		static auto getPos() { return getCursorPosition(); }
@@ -168,63 +169,76 @@ namespace sys::term {
 	 * @brief			Scroll the viewport up or down by a given number of lines.
 	 * @param upNotDown	When true, scrolls up. When false, scrolls down.
 	 * @param n			Number of lines to scroll.
-	 * @returns			Sequence
+	 * @returns			FixedSequence
 	 */
-	[[nodiscard]] inline Sequence ScrollBuffer(const bool& upNotDown, const unsigned& n)
+	[[nodiscard]] inline constexpr FixedSequence<> ScrollBuffer(const bool& upNotDown, const unsigned& n)
 	{
-		return Sequence(make_sequence(ESC, CSI, n, (upNotDown ? 'S' : 'T')));
+		return make_fixed_sequence(ESC, CSI, n, (upNotDown ? 'S' : 'T'));
 	}
 	/// @brief Scroll the viewport up by inserting lines from the bottom.
-	[[nodiscard]] inline Sequence ScrollUp(const unsigned& n) { return ScrollBuffer(true, n); }
+	[[nodiscard]] inline constexpr FixedSequence<> ScrollUp(const unsigned& n) { return ScrollBuffer(true, n); }
 	/// @brief Scroll the viewport down by inserting lines from the top.
-	[[nodiscard]] inline Sequence ScrollDown(const unsigned& n) { return ScrollBuffer(false, n); }
+	[[nodiscard]] inline constexpr FixedSequence<> ScrollDown(const unsigned& n) { return ScrollBuffer(false, n); }
+	/**
+	 * @brief			Set the top & bottom margins of the scrolling region. (DECSTBM) Line feeds & scrolling only affect the rows between the margins.
+	 *\n				Also moves the cursor to the home position.
+	 * @param top		The first row of the scrolling region.
+	 * @param bottom	The last row of the scrolling region.
+	 * @returns			FixedSequence
+	 */
+	[[nodiscard]] inline FixedSequence<> setScrollMargins(const unsigned& top, const unsigned& bottom)
+	{
+		return make_fixed_sequence(ESC, CSI, !!_internal::CURSOR_MIN_AXIS + top, ';', !!_internal::CURSOR_MIN_AXIS + bottom, 'r');
+	}
+	/// @brief Reset the scrolling region to the entire screen. Also moves the cursor to the home position.
+	[[nodiscard]] inline constexpr FixedSequence<> ResetScrollMargins() { return make_fixed_sequence(ESC, CSI, 'r'); }
 #pragma endregion Viewport
 
 #pragma region TextModification
 	/**
 	 * @brief	Inserts space characters at the current cursor position, shifting any existing text to the right.
 	 * @param n	Number of space characters to insert.
-	 * @returns Sequence
+	 * @returns FixedSequence
 	 */
-	[[nodiscard]] inline Sequence InsertChar(const unsigned& n = 1u)
+	[[nodiscard]] inline constexpr FixedSequence<> InsertChar(const unsigned& n = 1u)
 	{
-		return Sequence(make_sequence(ESC, CSI, n, '@'));
+		return make_fixed_sequence(ESC, CSI, n, '@');
 	}
 	/**
 	 * @brief	Deletes characters at the current cursor position, shifting any existing text from the right towards the cursor.
 	 * @param n Number of characters to delete.
-	 * @returns	Sequence
+	 * @returns	FixedSequence
 	 */
-	[[nodiscard]] inline Sequence DeleteChar(const unsigned& n = 1u)
+	[[nodiscard]] inline constexpr FixedSequence<> DeleteChar(const unsigned& n = 1u)
 	{
-		return Sequence(make_sequence(ESC, CSI, n, 'P'));
+		return make_fixed_sequence(ESC, CSI, n, 'P');
 	}
 	/**
 	 * @brief	Erases a given number of characters starting at the current cursor position by overwriting them with a space character. Any existing text is not shifted.
 	 * @param n Number of characters to erase.
-	 * @returns Sequence
+	 * @returns FixedSequence
 	 */
-	[[nodiscard]] inline Sequence EraseChar(const unsigned& n = 1u)
+	[[nodiscard]] inline constexpr FixedSequence<> EraseChar(const unsigned& n = 1u)
 	{
-		return Sequence(make_sequence(ESC, CSI, n, 'X'));
+		return make_fixed_sequence(ESC, CSI, n, 'X');
 	}
 	/**
 	 * @brief	Inserts empty lines above the current cursor position, shifting the cursor down.
 	 * @param n Number of lines to insert.
-	 * @returns Sequence
+	 * @returns FixedSequence
 	 */
-	[[nodiscard]] inline Sequence InsertLine(const unsigned& n = 1u)
+	[[nodiscard]] inline constexpr FixedSequence<> InsertLine(const unsigned& n = 1u)
 	{
-		return Sequence(make_sequence(ESC, CSI, n, 'L'));
+		return make_fixed_sequence(ESC, CSI, n, 'L');
 	}
 	/**
 	 * @brief	Deletes lines from the screen buffer, starting with the row the cursor is on, shifting any lines below the cursor upwards.
 	 * @param n Number of lines to delete.
-	 * @returns Sequence
+	 * @returns FixedSequence
 	 */
-	[[nodiscard]] inline Sequence DeleteLine(const unsigned& n = 1u)
+	[[nodiscard]] inline constexpr FixedSequence<> DeleteLine(const unsigned& n = 1u)
 	{
-		return Sequence(make_sequence(ESC, CSI, n, 'M'));
+		return make_fixed_sequence(ESC, CSI, n, 'M');
 	}
 	/**
 	 * @enum EraseScope
@@ -246,15 +260,15 @@ namespace sys::term {
 	 *				- _0_ / _CURSOR_TO_END_		Erases all text from the current cursor position until the end of the viewport.
 	 *				- _1_ / _BEGIN_TO_CURSOR_	Erases all text from the beginning of the viewport until & including the current cursor position.
 	 *				- _2_ / _ALL_TEXT_			Erases all text in the entire viewport.
-	 * @returns		Sequence
+	 * @returns		FixedSequence
 	 */
 	template<EraseInType T>
-	[[nodiscard]] inline Sequence EraseInDisplay(const T& erase_scope) noexcept(false)
+	[[nodiscard]] inline constexpr FixedSequence<> EraseInDisplay(const T& erase_scope) noexcept(false)
 	{
 		if constexpr (!std::same_as<T, EraseScope>)
 			if (erase_scope < 0 || erase_scope > 2)
-				throw std::exception(str::stringify("EraseInDisplay()\tInvalid erase_scope specifier: \'", erase_scope, "\'! Valid Modes: [0/CURSOR_TO_END|1/BEGIN_TO_CURSOR|2/ALL_TEXT]").c_str());
-		return Sequence(make_sequence(ESC, CSI, erase_scope, 'J'));
+				throw make_exception("EraseInDisplay()\tInvalid erase_scope specifier: \'", erase_scope, "\'! Valid Modes: [0/CURSOR_TO_END|1/BEGIN_TO_CURSOR|2/ALL_TEXT]");
+		return make_fixed_sequence(ESC, CSI, erase_scope, 'J');
 	}
 	/**
 	 * @brief		Replaces all text within the current line as specified by the given mode with space characters.
@@ -262,15 +276,15 @@ namespace sys::term {
 	 *				- _0_ / _CURSOR_TO_END_		Erases all text from the current cursor position (inclusive) to EOL.
 	 *				- _1_ / _BEGIN_TO_CURSOR_	Erases all text from the SOL to the current cursor position (inclusive).
 	 *				- _2_ / _ALL_TEXT_			Erases all text on the current line.
-	 * @returns		Sequence
+	 * @returns		FixedSequence
 	 */
 	template<EraseInType T>
-	[[nodiscard]] inline Sequence EraseInLine(const T& erase_scope) noexcept(false)
+	[[nodiscard]] inline constexpr FixedSequence<> EraseInLine(const T& erase_scope) noexcept(false)
 	{
 		if constexpr (!std::same_as<T, EraseScope>)
 			if (erase_scope < 0 || erase_scope > 2)
-				throw std::exception(str::stringify("EraseInLine()\tInvalid mode specifier: \'", erase_scope, "\'! Valid Modes: [0/CURSOR_TO_END|1/BEGIN_TO_CURSOR|2/ALL_TEXT]").c_str());
-		return Sequence(make_sequence(ESC, CSI, erase_scope, 'K'));
+				throw make_exception("EraseInLine()\tInvalid mode specifier: \'", erase_scope, "\'! Valid Modes: [0/CURSOR_TO_END|1/BEGIN_TO_CURSOR|2/ALL_TEXT]");
+		return make_fixed_sequence(ESC, CSI, erase_scope, 'K');
 	}
 #pragma endregion TextModification
 
@@ -278,12 +292,12 @@ namespace sys::term {
 	/**
 	 * @brief		Set the format of the screen and text as specified by the given mode.
 	 * @param mode	All possible modes: https://docs.microsoft.com/en-us/windows/console/console-virtual-terminal-sequences#text-formatting
-	 * @returns		Sequence
+	 * @returns		FixedSequence
 	 */
 	template<std::integral T>
-	[[nodiscard]] inline Sequence SetGraphicsRendition(const T& mode)
+	[[nodiscard]] inline constexpr FixedSequence<> SetGraphicsRendition(const T& mode)
 	{
-		return Sequence(make_sequence(ESC, CSI, mode, 'm'));
+		return make_fixed_sequence(ESC, CSI, mode, 'm');
 	}
 	/**
 	 * @brief		Set the format of the screen and text as specified by the given mode.
@@ -322,76 +336,123 @@ namespace sys::term {
 	 * @brief			Set the operation mode for the numberpad/cursor keys.
 	 * @param target	Select the target keys to change the operation mode of.
 	 * @param mode		Select the mode to apply.
-	 * @returns			Sequence
+	 * @returns			FixedSequence
 	 */
-	inline Sequence setKeyMode(const KeyModeTarget& target, const KeyMode& mode)
+	inline constexpr FixedSequence<> setKeyMode(const KeyModeTarget& target, const KeyMode& mode)
 	{
 		switch (target) {
 		case KeyModeTarget::KEYPAD:
-			return Sequence(make_sequence(ESC, (mode == KeyMode::APPLICATION ? '=' : '>')));
+			return make_fixed_sequence(ESC, (mode == KeyMode::APPLICATION ? '=' : '>'));
 		case KeyModeTarget::CURSOR_KEYS:
-			return Sequence(make_sequence(ESC, CSI, "?1", (mode == KeyMode::APPLICATION ? ENABLE : DISABLE)));
+			return make_fixed_sequence(ESC, CSI, "?1", (mode == KeyMode::APPLICATION ? ENABLE : DISABLE));
 		}
 	}
 	/// @brief	Enable application mode for the specified keys.
-	inline Sequence EnableApplicationMode(const KeyModeTarget& target)
+	inline constexpr FixedSequence<> EnableApplicationMode(const KeyModeTarget& target)
 	{
 		return setKeyMode(target, KeyMode::APPLICATION);
 	}
 	/// @brief	Disable application mode for the specified keys.
-	inline Sequence DisableApplicationMode(const KeyModeTarget& target)
+	inline constexpr FixedSequence<> DisableApplicationMode(const KeyModeTarget& target)
 	{
 		return setKeyMode(target, KeyMode::DEFAULT);
 	}
+	/**
+	 * @brief			Enable or disable SGR (1006) mouse reporting. Reports are decoded by InputDecoder as InputEventType::MOUSE events.
+	 * @param enable	When true, enables mouse reporting; otherwise disables it.
+	 * @param motion	When true, mouse movement is reported even when no buttons are held.
+	 * @returns			FixedSequence
+	 */
+	inline constexpr FixedSequence<> setMouseReporting(const bool& enable, const bool& motion = false)
+	{
+		return make_fixed_sequence(ESC, CSI, (motion ? "?1003;1006" : "?1000;1006"), (enable ? ENABLE : DISABLE));
+	}
+	/**
+	 * @brief			Enable or disable bracketed paste mode, which allows InputDecoder to tell pasted text apart from typed text.
+	 * @param enable	When true, enables bracketed paste; otherwise disables it.
+	 * @returns			FixedSequence
+	 */
+	inline constexpr FixedSequence<> setBracketedPaste(const bool& enable)
+	{
+		return make_fixed_sequence(ESC, CSI, "?2004", (enable ? ENABLE : DISABLE));
+	}
+	/**
+	 * @brief			Enable or disable focus reporting, which is decoded by InputDecoder as FOCUS_IN & FOCUS_OUT events.
+	 * @param enable	When true, enables focus reporting; otherwise disables it.
+	 * @returns			FixedSequence
+	 */
+	inline constexpr FixedSequence<> setFocusReporting(const bool& enable)
+	{
+		return make_fixed_sequence(ESC, CSI, "?1004", (enable ? ENABLE : DISABLE));
+	}
+	/**
+	 * @brief			Enable or disable automatic wrapping. (DECAWM) While disabled, text written past the last column overwrites the last cell instead of wrapping.
+	 * @param enable	When true, enables automatic wrapping; otherwise disables it.
+	 * @returns			FixedSequence
+	 */
+	inline constexpr FixedSequence<> setAutoWrap(const bool& enable)
+	{
+		return make_fixed_sequence(ESC, CSI, "?7", (enable ? ENABLE : DISABLE));
+	}
+	/**
+	 * @brief			Begin or end a synchronized update. (DEC private mode 2026) While enabled, the terminal holds off on presenting output until the update ends.
+	 *\n				Terminals that don't support the mode ignore it. See FrameTransaction.
+	 * @param enable	When true, begins a synchronized update; otherwise ends it.
+	 * @returns			FixedSequence
+	 */
+	inline constexpr FixedSequence<> setSynchronizedOutput(const bool& enable)
+	{
+		return make_fixed_sequence(ESC, CSI, "?2026", (enable ? ENABLE : DISABLE));
+	}
 
 #pragma endregion ModeChanges
 
 #pragma region Tabs
 	/**
 	 * @brief	Sets a tab stop at the current cursor column, causing any applicable tab characters to align to the current column.
-	 * @returns Sequence
+	 * @returns FixedSequence
 	 */
-	[[nodiscard]] inline Sequence SetTabStop()
+	[[nodiscard]] inline constexpr FixedSequence<> SetTabStop()
 	{
-		return Sequence(make_sequence(ESC, 'H'));
+		return make_fixed_sequence(ESC, 'H');
 	}
 	/**
 	 * @brief	Move the cursor to the next column with a tab stop.
 	 *\n		If there are no more tab stops, move to the last column in the row.
 	 *\n		If the cursor is in the last column, move to the first column of the next row.
 	 * @param n	Number of tab stops to advance the cursor by.
-	 * @returns Sequence
+	 * @returns FixedSequence
 	 */
-	[[nodiscard]] inline Sequence CursorTabForward(const unsigned& n = 1u)
+	[[nodiscard]] inline constexpr FixedSequence<> CursorTabForward(const unsigned& n = 1u)
 	{
-		return Sequence(make_sequence(ESC, CSI, n, 'I'));
+		return make_fixed_sequence(ESC, CSI, n, 'I');
 	}
 	/**
 	 * @brief	Move the cursor to the previous column with a tab stop.
 	 *\n		If there are no more tab stops, moves the cursor to the first column.
 	 *\n		If the cursor is in the first column, doesnt move the cursor.
 	 * @param n
-	 * @returns Sequence
+	 * @returns FixedSequence
 	 */
-	[[nodiscard]] inline Sequence CursorTabBackward(const unsigned& n = 1u)
+	[[nodiscard]] inline constexpr FixedSequence<> CursorTabBackward(const unsigned& n = 1u)
 	{
-		return Sequence(make_sequence(ESC, CSI, n, 'Z'));
+		return make_fixed_sequence(ESC, CSI, n, 'Z');
 	}
 	/**
 	 * @brief		Removes tab stops from the current column, if there is one.
-	 * @returns		Sequence
+	 * @returns		FixedSequence
 	 */
-	[[nodiscard]] inline Sequence ClearTabStop()
+	[[nodiscard]] inline constexpr FixedSequence<> ClearTabStop()
 	{
-		return Sequence(make_sequence(ESC, CSI, "0g"));
+		return make_fixed_sequence(ESC, CSI, "0g");
 	}
 	/**
 	 * @brief	Clear all currently set tab stops.
-	 * @returns Sequence
+	 * @returns FixedSequence
 	 */
-	[[nodiscard]] inline Sequence ClearAllTabStops()
+	[[nodiscard]] inline constexpr FixedSequence<> ClearAllTabStops()
 	{
-		return Sequence(make_sequence(ESC, CSI, "3g"));
+		return make_fixed_sequence(ESC, CSI, "3g");
 	}
 #pragma endregion Tabs
 
@@ -411,27 +472,27 @@ namespace sys::term {
 	 *\n			MS Docs:		https://docs.microsoft.com/en-us/windows/console/console-virtual-terminal-sequences#designate-character-set
 	 *\n			DEC Characters: https://vt100.net/docs/vt220-rm/table2-4.html
 	 * @param chset	Character set to enable.
-	 * @returns		Sequence
+	 * @returns		FixedSequence
 	 */
-	[[nodiscard]] inline Sequence setCharacterSet(const CharacterSet& chset = CharacterSet::ASCII) noexcept(false)
+	[[nodiscard]] inline FixedSequence<> setCharacterSet(const CharacterSet& chset = CharacterSet::ASCII) noexcept(false)
 	{
 		if (const auto chset_ch{ static_cast<char>(chset) }; chset_ch != static_cast<char>(CharacterSet::ASCII) && chset_ch != static_cast<char>(CharacterSet::DEC_LINE_DRAWING))
-			throw std::exception(str::stringify("setCharacterSet()\tReceived invalid chset value: \'", chset_ch, "\'").c_str());
-		return Sequence(make_sequence(ESC, CHARACTER_SET, static_cast<unsigned char>(chset)));
+			throw make_exception("setCharacterSet()\tReceived invalid chset value: \'", chset_ch, "\'");
+		return make_fixed_sequence(ESC, CHARACTER_SET, static_cast<unsigned char>(chset));
 	}
 	/**
 	 * @brief	Set the character set to DEC Line Drawing.
-	 * @returns Sequence
+	 * @returns FixedSequence
 	 */
-	[[nodiscard]] inline Sequence setLineDrawingMode()
+	[[nodiscard]] inline FixedSequence<> setLineDrawingMode()
 	{
 		return setCharacterSet(CharacterSet::DEC_LINE_DRAWING);
 	}
 	/**
 	 * @brief	Set the character set to ASCII.
-	 * @returns Sequence
+	 * @returns FixedSequence
 	 */
-	[[nodiscard]] inline Sequence unsetLineDrawingMode()
+	[[nodiscard]] inline FixedSequence<> unsetLineDrawingMode()
 	{
 		return setCharacterSet(CharacterSet::ASCII);
 	}
@@ -442,13 +503,13 @@ namespace sys::term {
 	/**
 	 * @brief		Set the console window title to a given string.
 	 * @param title	A string shorter than 254 characters. If the string is longer, it will be truncated.
-	 * @returns		Sequence
+	 * @returns		FixedSequence
 	 */
-	[[nodiscard]] inline Sequence setWindowTitle(std::string title)
+	[[nodiscard]] inline constexpr FixedSequence<259ull> setWindowTitle(std::string_view title)
 	{
 		if (title.size() >= 255ull)
 			title = title.substr(0ull, 254ull);
-		return Sequence(make_sequence(ESC, OSC, "0;", title.c_str(), STRING_TERMINATOR));
+		return make_fixed_sequence<259ull>(ESC, OSC, "0;", title, STRING_TERMINATOR);
 	}
 #pragma endregion WindowTitle
 
@@ -465,11 +526,11 @@ namespace sys::term {
 	 *			| Character Set			| US ASCII				|
 	 *			| Graphics Rendition	| Off					|
 	 *			| Saved Cursor Pos		| Origin Position		|
-	 * @returns	Sequence
+	 * @returns	FixedSequence
 	 */
-	[[nodiscard]] inline Sequence SoftReset()
+	[[nodiscard]] inline constexpr FixedSequence<> SoftReset()
 	{
-		return Sequence(make_sequence(ESC, CSI, "!p"));
+		return make_fixed_sequence(ESC, CSI, "!p");
 	}
 #pragma endregion SoftReset
 
@@ -477,16 +538,16 @@ namespace sys::term {
 	/**
 	 * @brief				Enable or disable the alternate screen buffer.
 	 * @param main_buffer	When true, the alternate screen buffer is enabled. When false, the screen buffer is set back to main.
-	 * @returns				Sequence
+	 * @returns				FixedSequence
 	 */
-	[[nodiscard]] inline Sequence setScreenBuffer(const bool& enable_alternate)
+	[[nodiscard]] inline constexpr FixedSequence<> setScreenBuffer(const bool& enable_alternate)
 	{
-		return Sequence(make_sequence(ESC, CSI, "?1049", (enable_alternate ? ENABLE : DISABLE)));
+		return make_fixed_sequence(ESC, CSI, "?1049", (enable_alternate ? ENABLE : DISABLE));
 	}
 	/// @brief Enable the alternate screen buffer.
-	[[nodiscard]] inline Sequence setAlternateScreenBuffer() { return std::move(setScreenBuffer(true)); }
+	[[nodiscard]] inline constexpr FixedSequence<> setAlternateScreenBuffer() { return setScreenBuffer(true); }
 	/// @brief Disable the alternate screen buffer.
-	[[nodiscard]] inline Sequence setMainScreenBuffer() { return setScreenBuffer(false); }
+	[[nodiscard]] inline constexpr FixedSequence<> setMainScreenBuffer() { return setScreenBuffer(false); }
 #pragma endregion AlternateScreenBuffer
 
 #pragma region Wrappers_ostream
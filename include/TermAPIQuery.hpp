@@ -8,8 +8,16 @@
 #include <sysarch.h>
 #include <ANSIDefs.h>
 #include <CursorOrigin.h>
+#include <query-engine.hpp>
+#include <color-transform.hpp>
 
+#include <make_exception.hpp>
 #include <str.hpp>
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <optional>
+#include <string_view>
 #include <utility>
 #include <thread>
 #ifdef OS_WIN
@@ -27,7 +35,8 @@ namespace sys::term {
 		/**
 		 * @brief Receive a query response from STDIN, and return it as a string.
 		 *\n	  It is ___highly discouraged___ to call this function from outside of TermAPIQuery.hpp!
-		 * @param timeout	- Maximum amount of wait cycles before breaking and returning nothing.
+		 *\n	  Prefer query(), which switches the terminal into raw mode before the request is written.
+		 * @param timeout	- Maximum amount of time to wait, in milliseconds, before breaking and returning nothing.
 		 * @returns std::string
 		 */
 		inline std::string get_query_response(const int& timeout = 256, const bool flush_output_stream = false) noexcept
@@ -41,13 +50,108 @@ namespace sys::term {
 			while (_kbhit()) // while a key is "pressed"
 				seq += static_cast<char>(_getch()); // get key code, cast to char
 		#else
-			std::cin.clear();
-			for (char c; !std::cin.fail() && std::cin >> c; )
-				seq += c;
-			std::cin.clear();
+			const RawMode raw;
+			if (!raw.active())
+				return seq;
+			ReplyParser parser;
+			if (read_query_reply(parser, [](auto&&) { return true; }, std::chrono::steady_clock::now() + std::chrono::milliseconds{ timeout }))
+				seq = parser.sequence();
 		#endif
 			return seq;
 		}
+
+		/**
+		 * @brief		Parse two semicolon-separated unsigned integers, such as the parameters of a cursor position report.
+		 * @param body	The parameter string; ex. "12;40".
+		 * @returns		std::optional<std::pair<unsigned long long, unsigned long long>>	std::nullopt when the string is malformed.
+		 */
+		inline std::optional<std::pair<unsigned long long, unsigned long long>> parse_number_pair(const std::string_view& body) noexcept
+		{
+			std::pair<unsigned long long, unsigned long long> result{ 0ull, 0ull };
+			bool select_second{ false }, has_first{ false }, has_second{ false };
+			for (const char c : body) {
+				if (c >= '0' && c <= '9') {
+					auto& target{ select_second ? result.second : result.first };
+					target = target * 10ull + static_cast<unsigned long long>(c - '0');
+					(select_second ? has_second : has_first) = true;
+				}
+				else if (c == ';' && !select_second)
+					select_second = true;
+				else return std::nullopt;
+			}
+			if (!has_first || !has_second)
+				return std::nullopt;
+			return result;
+		}
+
+		/**
+		 * @brief		Parse an X11 color specification in the form "rgb:RRRR/GGGG/BBBB", where each component has 1-4 hexadecimal digits.
+		 * @param spec	The color specification.
+		 * @returns		std::optional<color::RGB>	std::nullopt when the specification is malformed.
+		 */
+		inline std::optional<color::RGB> parse_xcolor(std::string_view spec) noexcept
+		{
+			if (!spec.starts_with("rgb:"))
+				return std::nullopt;
+			spec.remove_prefix(4ull);
+			std::uint8_t channels[3]{};
+			for (auto& channel : channels) {
+				std::uint32_t value{ 0u }, max{ 0u };
+				std::size_t digits{ 0ull };
+				for (; digits < spec.size() && spec[digits] != '/'; ++digits) {
+					const char c{ spec[digits] };
+					std::uint32_t digit;
+					if (c >= '0' && c <= '9') digit = static_cast<std::uint32_t>(c - '0');
+					else if (c >= 'a' && c <= 'f') digit = static_cast<std::uint32_t>(c - 'a' + 10);
+					else if (c >= 'A' && c <= 'F') digit = static_cast<std::uint32_t>(c - 'A' + 10);
+					else return std::nullopt;
+					value = (value << 4u) | digit;
+					max = (max << 4u) | 0xFu;
+				}
+				if (digits == 0ull || digits > 4ull)
+					return std::nullopt;
+				channel = static_cast<std::uint8_t>((value * 255u + max / 2u) / max);
+				spec.remove_prefix(std::min<std::size_t>(digits + 1ull, spec.size()));
+			}
+			return color::RGB{ channels[0], channels[1], channels[2] };
+		}
+
+		/// @brief	Get the body of a complete reply sequence, without its introducer & terminator.
+		inline std::string_view reply_body(const std::string_view& reply) noexcept
+		{
+			ReplyParser parser;
+			for (const char c : reply)
+				parser.feed(c);
+			const auto body{ parser.body() };
+			return body.empty() ? body : reply.substr(static_cast<std::size_t>(body.data() - parser.sequence().data()), body.size());
+		}
+	}
+
+	/**
+	 * @struct	CursorShadow
+	 * @brief	Interface for a local copy of the cursor position, such as CursorTracker. While one is registered, getCursorPosition() asks it first,
+	 *\n		and only queries the terminal when the shadow doesn't know the position.
+	 */
+	struct CursorShadow {
+		virtual ~CursorShadow() noexcept = default;
+		/// @brief	Get the 1-based (row, column) position of the cursor, or std::nullopt when it isn't known.
+		virtual std::optional<std::pair<unsigned, unsigned>> shadow_position() noexcept = 0;
+		/// @brief	Called with the 1-based (row, column) position reported by the terminal after the shadow didn't know it.
+		virtual void resync(const unsigned row, const unsigned column) noexcept = 0;
+	};
+
+	namespace _internal {
+		inline std::atomic<CursorShadow*> cursor_shadow{ nullptr };
+	}
+
+	/**
+	 * @brief			Register the cursor shadow that getCursorPosition() consults before querying the terminal.
+	 * @param shadow	The new shadow, or nullptr to always query the terminal. It must remain valid until it is removed.
+	 * @returns			CursorShadow*	The previous shadow.
+	 */
+	inline CursorShadow* setCursorShadow(CursorShadow* shadow) noexcept
+	{
+		return _internal::cursor_shadow.exchange(shadow, std::memory_order_acq_rel);
 	}
 
 	/**
@@ -63,49 +167,42 @@ namespace sys::term {
 
 	/**
 	 * @brief Retrieve the current position of the cursor, measured in characters of the screen buffer.
+	 *\n	  Waits at most DEFAULT_QUERY_TIMEOUT for the terminal to answer. When a CursorShadow is registered & knows the position, the terminal isn't queried at all.
+	 *\n	  Output that is pending in the calling thread's OutputWriter is flushed first, even when a batch is active, so that the position accounts for it.
 	 * @tparam RT	- Templated Return Type (Integral)
 	 * @returns std::pair<RT, RT>
+	 * @throws std::exception	The terminal didn't answer in time, or answered with a malformed reply.
 	 */
 	template<std::integral RT = unsigned short>
 	inline std::pair<RT, RT> getCursorPosition() noexcept(false)
 	{
+		if (auto& writer{ getOutputWriter() }; writer.size() != 0ull)
+			writer.flush();
+		auto* shadow{ _internal::cursor_shadow.load(std::memory_order_acquire) };
+		if (shadow != nullptr)
+			if (const auto pos{ shadow->shadow_position() }; pos.has_value())
+				return{ static_cast<RT>(!!_internal::CURSOR_MIN_AXIS + pos.value().first), static_cast<RT>(!!_internal::CURSOR_MIN_AXIS + pos.value().second) };
+	#ifdef OS_WIN
 		ReportCursorPosition();
-		std::string row, col;
-		bool select_col{ false }; ///< @brief when true, appends digits to column; else, appends to row.
-		for (auto& c : _internal::get_query_response()) {
-			using namespace ANSI;
-			switch (c) {
-			case '0': [[fallthrough]];
-			case '1': [[fallthrough]];
-			case '2': [[fallthrough]];
-			case '3': [[fallthrough]];
-			case '4': [[fallthrough]];
-			case '5': [[fallthrough]];
-			case '6': [[fallthrough]];
-			case '7': [[fallthrough]];
-			case '8': [[fallthrough]];
-			case '9':
-				if (!select_col)
-					row += c;
-				else
-					col += c;
-				break;
-			case ';': // delim
-				select_col = true;
-				break;
-			case ESC: [[fallthrough]];// ESC
-			case CSI:
-				break;
-			case 'R': // sequence end
-				if (!row.empty() && !col.empty()) // divider delim has been reached
-					return{ static_cast<RT>(!!_internal::CURSOR_MIN_AXIS + str::stoull(row)), static_cast<RT>(!!_internal::CURSOR_MIN_AXIS + str::stoull(col)) };
-				// else:
-				[[fallthrough]];
-			default:
-				throw std::exception(str::stringify("getCursorPosition()\tReceived unexpected character: \'", c, "\'!").c_str());
-			}
+		const auto response{ _internal::get_query_response() };
+		ReplyParser parser;
+		for (const char c : response)
+			parser.feed(c);
+		if (!parser.complete() || parser.final_byte() != 'R')
+			throw make_exception("getCursorPosition()\tDidn't receive expected escape sequence! No ending character found!");
+		const auto body{ parser.body() };
+	#else
+		const auto reply{ query(make_sequence(ESC, CSI, "6n"), 'R') };
+		if (!reply.has_value())
+			throw make_exception("getCursorPosition()\tThe terminal didn't report the cursor position!");
+		const std::string_view body{ std::string_view{ reply.value() }.substr(2ull, reply.value().size() - 3ull) };
+	#endif
+		if (const auto pos{ _internal::parse_number_pair(body) }; pos.has_value()) {
+			if (shadow != nullptr)
+				shadow->resync(static_cast<unsigned>(pos.value().first), static_cast<unsigned>(pos.value().second));
+			return{ static_cast<RT>(!!_internal::CURSOR_MIN_AXIS + pos.value().first), static_cast<RT>(!!_internal::CURSOR_MIN_AXIS + pos.value().second) };
 		}
-		throw std::exception("getCursorPosition()\tDidn't receive expected escape sequence! No ending character found!");
+		throw make_exception("getCursorPosition()\tReceived malformed cursor position report: \'", body, "\'!");
 	}
 
 	/**
@@ -117,10 +214,154 @@ namespace sys::term {
 		std::cout << ESC << CSI << "0c";
 	}
 
-
+	/**
+	 * @brief	Retrieve the device attributes reported by the terminal.
+	 * @returns	std::string	The complete reply, or an empty string when the terminal didn't answer in time.
+	 */
 	inline std::string getDeviceAttributes() noexcept
 	{
+	#ifdef OS_WIN
 		ReportDeviceAttributes();
 		return _internal::get_query_response();
+	#else
+		try {
+			return query(make_sequence(ESC, CSI, "0c"), 'c').value_or(std::string{});
+		} catch (...) {
+			return{};
+		}
+	#endif
+	}
+
+	/**
+	 * @enum	ModeState
+	 * @brief	The state of a terminal mode, as reported by queryPrivateMode().
+	 */
+	enum class ModeState : unsigned char {
+		/// @brief	The terminal doesn't recognize the mode.
+		NOT_RECOGNIZED = 0u,
+		/// @brief	The mode is enabled.
+		SET = 1u,
+		/// @brief	The mode is disabled.
+		RESET = 2u,
+		/// @brief	The mode is enabled & can't be changed.
+		PERMANENTLY_SET = 3u,
+		/// @brief	The mode is disabled & can't be changed.
+		PERMANENTLY_RESET = 4u,
+	};
+
+	/**
+	 * @brief			Query the state of a DEC private mode. (DECRQM)
+	 *\n				The request is followed by DA1, so terminals that don't implement DECRQM cost a single round trip instead of the full timeout.
+	 * @param mode		The number of the private mode; ex. 2026 for synchronized output.
+	 * @param timeout	The maximum amount of time to wait for the reply.
+	 * @returns			std::optional<ModeState>	std::nullopt when the terminal didn't answer, or answered with a malformed reply.
+	 */
+	inline std::optional<ModeState> queryPrivateMode(const unsigned& mode, const std::chrono::microseconds& timeout = DEFAULT_QUERY_TIMEOUT)
+	{
+		const std::string prefix{ '?' + std::to_string(mode) + ';' };
+		const auto replies{ query_batch({
+			{ make_sequence(ESC, CSI, '?', mode, "$p"), [&prefix](const ReplyParser& p) { return p.kind() == ReplyParser::Kind::CSI && p.final_byte() == 'y' && p.body().starts_with(prefix); } },
+			{ make_sequence(ESC, CSI, 'c'), [](const ReplyParser& p) { return p.kind() == ReplyParser::Kind::CSI && p.final_byte() == 'c' && p.body().starts_with('?'); } }, // sentinel
+		}, timeout) };
+		if (!replies.front().has_value())
+			return std::nullopt;
+		const auto body{ _internal::reply_body(replies.front().value()).substr(prefix.size()) };
+		if (body.size() != 2ull || body.back() != '$' || body.front() < '0' || body.front() > '4')
+			return std::nullopt;
+		return static_cast<ModeState>(body.front() - '0');
+	}
+
+	namespace _internal {
+		/// @brief	Whether the terminal supports synchronized output; 1 or 0 once detected, -1 until then.
+		inline std::atomic<int> synchronized_output{ -1 };
+	}
+
+	/**
+	 * @brief			Check if the terminal supports synchronized output (DEC private mode 2026). The terminal is only queried the first time.
+	 * @param timeout	The maximum amount of time to wait for the terminal to answer, if it hasn't been queried yet.
+	 * @returns			bool
+	 */
+	inline bool isSynchronizedOutputSupported(const std::chrono::microseconds& timeout = DEFAULT_QUERY_TIMEOUT)
+	{
+		auto supported{ _internal::synchronized_output.load(std::memory_order_acquire) };
+		if (supported < 0) {
+			const auto state{ queryPrivateMode(2026u, timeout) };
+			supported = state.has_value() && state.value() != ModeState::NOT_RECOGNIZED && state.value() != ModeState::PERMANENTLY_RESET;
+			_internal::synchronized_output.store(supported, std::memory_order_release);
+		}
+		return supported == 1;
+	}
+	/**
+	 * @brief			Override the result of isSynchronizedOutputSupported(), such as when the output isn't a terminal that can be queried.
+	 * @param supported	Whether synchronized output is supported.
+	 */
+	inline void setSynchronizedOutputSupported(const bool supported) noexcept
+	{
+		_internal::synchronized_output.store(supported, std::memory_order_release);
+	}
+
+	/**
+	 * @struct	TerminalInfo
+	 * @brief	The results of getTerminalInfo(). Each member is std::nullopt when the terminal didn't answer the corresponding query.
+	 */
+	struct TerminalInfo {
+		/// @brief	The cursor position as (row, column), measured the same way as getCursorPosition().
+		std::optional<std::pair<unsigned short, unsigned short>> cursor_position;
+		/// @brief	The size of the text area as (rows, columns). (XTWINOPS 18)
+		std::optional<std::pair<unsigned short, unsigned short>> window_size;
+		/// @brief	The parameters of the primary device attributes reply; ex. "?62;22". (DA1)
+		std::optional<std::string> device_attributes;
+		/// @brief	The parameters of the secondary device attributes reply; ex. ">1;95;0". (DA2)
+		std::optional<std::string> secondary_device_attributes;
+		/// @brief	The terminal's name & version; ex. "xterm(379)". (XTVERSION)
+		std::optional<std::string> version;
+		/// @brief	The default foreground color. (OSC 10)
+		std::optional<color::RGB> foreground;
+		/// @brief	The default background color. (OSC 11)
+		std::optional<color::RGB> background;
+	};
+
+	/**
+	 * @brief			Query the cursor position, window size, device attributes, terminal version, & default colors in a single round trip.
+	 *\n				All of the requests are sent in one write, followed by DA1, which every terminal answers last; unsupported queries therefore don't cost the full timeout.
+	 * @param timeout	The maximum amount of time to wait for all of the replies.
+	 * @returns			TerminalInfo
+	 */
+	inline TerminalInfo getTerminalInfo(const std::chrono::microseconds& timeout = DEFAULT_QUERY_TIMEOUT)
+	{
+		using Kind = ReplyParser::Kind;
+		const auto csi_reply{ [](const char final_char, const std::string_view& body_prefix) -> QueryRouter::predicate_type {
+			return [final_char, body_prefix](const ReplyParser& p) { return p.kind() == Kind::CSI && p.final_byte() == final_char && p.body().starts_with(body_prefix); };
+		} };
+		const auto string_reply{ [](const Kind kind, const std::string_view& body_prefix) -> QueryRouter::predicate_type {
+			return [kind, body_prefix](const ReplyParser& p) { return p.kind() == kind && p.body().starts_with(body_prefix); };
+		} };
+		const auto replies{ query_batch({
+			{ make_sequence(ESC, CSI, "6n"), csi_reply('R', "") },
+			{ make_sequence(ESC, CSI, "18t"), csi_reply('t', "8;") },
+			{ make_sequence(ESC, CSI, ">c"), csi_reply('c', ">") },
+			{ make_sequence(ESC, CSI, ">0q"), string_reply(Kind::DCS, ">|") },
+			{ make_sequence(ESC, OSC, "10;?", ESC, '\\'), string_reply(Kind::OSC, "10;") },
+			{ make_sequence(ESC, OSC, "11;?", ESC, '\\'), string_reply(Kind::OSC, "11;") },
+			{ make_sequence(ESC, CSI, 'c'), csi_reply('c', "?") }, // sentinel
+		}, timeout) };
+
+		TerminalInfo info;
+		const auto body{ [&replies](const std::size_t i) { return replies[i].has_value() ? _internal::reply_body(replies[i].value()) : std::string_view{}; } };
+		if (const auto pos{ _internal::parse_number_pair(body(0)) }; pos.has_value())
+			info.cursor_position = std::make_pair(static_cast<unsigned short>(!!_internal::CURSOR_MIN_AXIS + pos.value().first), static_cast<unsigned short>(!!_internal::CURSOR_MIN_AXIS + pos.value().second));
+		if (const auto size{ _internal::parse_number_pair(body(1).substr(std::min<std::size_t>(2ull, body(1).size()))) }; size.has_value())
+			info.window_size = std::make_pair(static_cast<unsigned short>(size.value().first), static_cast<unsigned short>(size.value().second));
+		if (replies[2].has_value())
+			info.secondary_device_attributes = std::string{ body(2) };
+		if (replies[3].has_value())
+			info.version = std::string{ body(3).substr(2ull) };
+		if (replies[4].has_value())
+			info.foreground = _internal::parse_xcolor(body(4).substr(3ull));
+		if (replies[5].has_value())
+			info.background = _internal::parse_xcolor(body(5).substr(3ull));
+		if (replies[6].has_value())
+			info.device_attributes = std::string{ body(6) };
+		return info;
 	}
-}
\ No newline at end of file
+}
@@ -0,0 +1,90 @@
+/**
+ * @file	color-sequence-table.hpp
+ * @author	radj307
+ * @brief	Contains a compile-time table of the SGR sequences for every 256-color palette entry, on both layers.
+ */
+#pragma once
+#include <ANSIDefs.h>
+
+#include <string_view>
+
+namespace color {
+	namespace _internal {
+		/// @brief	The number of characters reserved for each table entry. The longest entry is "ESC[38;5;255m", which is 11 characters.
+		inline constexpr const std::size_t COLOR_SEQUENCE_STRIDE{ 12ull };
+		/// @brief	The number of characters before the parameters of each entry. ("ESC[")
+		inline constexpr const std::size_t COLOR_SEQUENCE_PREFIX{ 2ull };
+
+		/// @brief	Storage for the color sequence table. Foreground entries come first, followed by background entries.
+		struct color_sequence_table {
+			char characters[512ull * COLOR_SEQUENCE_STRIDE]{};
+			unsigned char length[512ull]{};
+		};
+
+		/// @brief	Build the color sequence table. Only used at compile time.
+		consteval color_sequence_table make_color_sequence_table()
+		{
+			color_sequence_table table{};
+			for (std::size_t i{ 0ull }; i < 512ull; ++i) {
+				char* const begin{ table.characters + i * COLOR_SEQUENCE_STRIDE };
+				char* pos{ begin };
+				*pos++ = ANSI::ESC;
+				*pos++ = ANSI::CSI;
+				for (const char* layer{ i < 256ull ? ANSI::FORE : ANSI::BACK }; *layer != '\0'; ++layer)
+					*pos++ = *layer;
+				*pos++ = ';';
+				pos = ANSI::encode_param(pos, static_cast<unsigned>(i % 256ull));
+				*pos++ = ANSI::END[0];
+				table.length[i] = static_cast<unsigned char>(pos - begin);
+			}
+			return table;
+		}
+
+		/// @brief	The SGR sequences for every color on both layers, generated at compile time.
+		inline constexpr const color_sequence_table COLOR_SEQUENCES{ make_color_sequence_table() };
+	}
+
+	/**
+	 * @brief				Retrieve the escape sequence that sets a 256-color palette entry, without formatting or allocating.
+	 * @param color			A color index from 0 to 255.
+	 * @param foreground	When true, the sequence sets the foreground color, otherwise it sets the background color.
+	 * @returns				std::string_view	A view of static storage, such as "ESC[38;5;196m".
+	 */
+	inline constexpr std::string_view color_sequence(const unsigned char color, const bool foreground = true) noexcept
+	{
+		const std::size_t i{ color + (foreground ? 0ull : 256ull) };
+		return{ _internal::COLOR_SEQUENCES.characters + i * _internal::COLOR_SEQUENCE_STRIDE, _internal::COLOR_SEQUENCES.length[i] };
+	}
+	/**
+	 * @brief				Retrieve only the SGR parameters that set a 256-color palette entry, for use within a larger SGR sequence.
+	 * @param color			A color index from 0 to 255.
+	 * @param foreground	When true, the parameters set the foreground color, otherwise they set the background color.
+	 * @returns				std::string_view	A view of static storage, such as "38;5;196".
+	 */
+	inline constexpr std::string_view color_parameters(const unsigned char color, const bool foreground = true) noexcept
+	{
+		const auto seq{ color_sequence(color, foreground) };
+		return seq.substr(_internal::COLOR_SEQUENCE_PREFIX, seq.size() - _internal::COLOR_SEQUENCE_PREFIX - 1ull);
+	}
+
+	/**
+	 * @brief				Retrieve the SGR parameter that sets one of the 16 standard colors, for terminals that don't support the 256-color palette.
+	 * @param color			A color index from 0 to 15.
+	 * @param foreground	When true, the parameter sets the foreground color (30-37, 90-97), otherwise it sets the background color (40-47, 100-107).
+	 * @returns				std::string_view	A view of static storage, such as "91".
+	 */
+	inline constexpr std::string_view basic_color_parameters(const unsigned char color, const bool foreground = true) noexcept
+	{
+		constexpr const std::string_view parameters[32]{
+			"30", "31", "32", "33", "34", "35", "36", "37", "90", "91", "92", "93", "94", "95", "96", "97",
+			"40", "41", "42", "43", "44", "45", "46", "47", "100", "101", "102", "103", "104", "105", "106", "107",
+		};
+		return parameters[(color & 15u) + (foreground ? 0u : 16u)];
+	}
+
+	static_assert(color_sequence(0u) == "\x1b[38;5;0m");
+	static_assert(color_sequence(255u, false) == "\x1b[48;5;255m");
+	static_assert(color_parameters(42u) == "38;5;42");
+	static_assert(basic_color_parameters(1u) == "31" && basic_color_parameters(9u) == "91");
+	static_assert(basic_color_parameters(0u, false) == "40" && basic_color_parameters(15u, false) == "107");
+}
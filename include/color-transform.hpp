@@ -3,14 +3,27 @@
  * @author	radj307
  * @brief	Contains functions for transforming color values between different formats.
  */
+#pragma once
 #include <sysarch.h>
 #include <make_exception.hpp>
 #include <str.hpp>
 #include <var.hpp>
 
+#include <array>
+#include <atomic>
 #include <cmath>
+#include <cstdint>
+#include <tuple>
 #include <utility>
 
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define COLOR_TRANSFORM_SSE2
+#elif defined(__ARM_NEON) || defined(_M_ARM64)
+#include <arm_neon.h>
+#define COLOR_TRANSFORM_NEON
+#endif
+
 namespace color {
 	/**
 	 * @brief		Convert an RGB value to a SGR color value.
@@ -24,7 +37,7 @@ namespace color {
 	template<typename T>
 	inline CONSTEXPR const std::enable_if_t<std::is_integral_v<T>, T> rgb_to_sgr(const T& r, const T& g, const T& b)
 	{
-		return { r * static_cast<T>(36) + g * static_cast<T>(6) + (b + static_cast<T>(16)) };
+		return static_cast<T>(r * static_cast<T>(36) + g * static_cast<T>(6) + (b + static_cast<T>(16)));
 	}
 
 	/**
@@ -46,15 +59,18 @@ namespace color {
 	}
 
 	/**
-	 * @brief
+	 * @brief				Convert a color cube SGR color value to its position in the cube. Use palette_to_rgb to get the actual RGB value of any index.
 	 * @tparam T			Any integral type.
-	 * @param sgr_color
-	 * @return
+	 * @param sgr_color		A color cube index. (Range: 16 - 231)
+	 * @returns				std::tuple<T, T, T>	The red, green, & blue cube coordinates. (Range: 0 - 5)
+	 * @throws				std::exception	The index isn't part of the color cube.
 	 */
 	template<typename T>
 	inline CONSTEXPR const std::enable_if_t<std::is_integral_v<T>, std::tuple<T, T, T>> sgr_to_rgb(const T& sgr_color)
 	{
-		T tmp{ sgr_color - static_cast<T>(16) };
+		if (sgr_color < static_cast<T>(16) || sgr_color > static_cast<T>(231))
+			throw make_exception("sgr_to_rgb():\tColor index ", +sgr_color, " isn't part of the 6x6x6 color cube!");
+		T tmp{ static_cast<T>(sgr_color - static_cast<T>(16)) };
 
 		T blue{ tmp % static_cast<T>(6) };
 		tmp /= static_cast<T>(6);
@@ -64,4 +80,255 @@ namespace color {
 
 		return{ tmp, green, blue };
 	}
-}
\ No newline at end of file
+
+	/**
+	 * @struct	RGB
+	 * @brief	A 24-bit color value.
+	 */
+	struct RGB {
+		std::uint8_t r{ 0u }, g{ 0u }, b{ 0u };
+
+		constexpr RGB() = default;
+		constexpr RGB(const std::uint8_t r, const std::uint8_t g, const std::uint8_t b) : r{ r }, g{ g }, b{ b } {}
+		/// @brief	Construct from a hexadecimal value in the form 0xRRGGBB.
+		constexpr explicit RGB(const std::uint32_t hex) : r{ static_cast<std::uint8_t>(hex >> 16u) }, g{ static_cast<std::uint8_t>(hex >> 8u) }, b{ static_cast<std::uint8_t>(hex) } {}
+
+		/// @brief	Pack this color into the form 0xRRGGBB.
+		constexpr std::uint32_t packed() const noexcept { return (static_cast<std::uint32_t>(r) << 16u) | (static_cast<std::uint32_t>(g) << 8u) | b; }
+
+		constexpr bool operator==(const RGB&) const = default;
+	};
+
+	/**
+	 * @enum	ColorDepth
+	 * @brief	The number of colors that the terminal can display.
+	 */
+	enum class ColorDepth : unsigned char {
+		/// @brief	Only the 16 standard colors. (SGR 30-37, 90-97 / 38;5;0-15)
+		COLOR_16,
+		/// @brief	The xterm 256-color palette. (38;5;n)
+		COLOR_256,
+		/// @brief	24-bit color. (38;2;r;g;b)
+		TRUECOLOR,
+	};
+
+	namespace color_settings {
+		/// @brief	The color depth used when emitting RGB colors. RGB colors are downgraded to the nearest palette index when this is less than TRUECOLOR.
+		inline ColorDepth colorDepth{ ColorDepth::TRUECOLOR };
+		/// @brief	Incremented by setColorDepth(), so that output rendered for one color depth can be cached until the depth changes.
+		inline std::atomic<unsigned> generation{ 0u };
+	}
+
+	/**
+	 * @brief			Set the color depth used when emitting RGB colors.
+	 * @param depth		The new color depth.
+	 * @returns			ColorDepth	The previous color depth.
+	 */
+	inline ColorDepth setColorDepth(const ColorDepth depth) noexcept
+	{
+		const auto copy{ color_settings::colorDepth };
+		color_settings::colorDepth = depth;
+		color_settings::generation.fetch_add(1u, std::memory_order_release);
+		return copy;
+	}
+	/// @brief	Get the color depth used when emitting RGB colors.
+	inline ColorDepth getColorDepth() noexcept { return color_settings::colorDepth; }
+
+	namespace _internal {
+		/// @brief	The channel intensities used by the xterm 6x6x6 color cube.
+		inline constexpr const std::uint8_t CUBE_LEVELS[6]{ 0u, 95u, 135u, 175u, 215u, 255u };
+
+		/// @brief	Build the xterm 256-color reference table. Only used at compile time.
+		consteval std::array<RGB, 256> make_xterm_palette()
+		{
+			std::array<RGB, 256> palette{ {
+				{ 0u, 0u, 0u }, { 205u, 0u, 0u }, { 0u, 205u, 0u }, { 205u, 205u, 0u },
+				{ 0u, 0u, 238u }, { 205u, 0u, 205u }, { 0u, 205u, 205u }, { 229u, 229u, 229u },
+				{ 127u, 127u, 127u }, { 255u, 0u, 0u }, { 0u, 255u, 0u }, { 255u, 255u, 0u },
+				{ 92u, 92u, 255u }, { 255u, 0u, 255u }, { 0u, 255u, 255u }, { 255u, 255u, 255u },
+			} };
+			for (std::size_t i{ 0ull }; i < 216ull; ++i)
+				palette[16ull + i] = RGB{ CUBE_LEVELS[i / 36ull], CUBE_LEVELS[i / 6ull % 6ull], CUBE_LEVELS[i % 6ull] };
+			for (std::size_t i{ 0ull }; i < 24ull; ++i) {
+				const auto level{ static_cast<std::uint8_t>(8ull + i * 10ull) };
+				palette[232ull + i] = RGB{ level, level, level };
+			}
+			return palette;
+		}
+	}
+
+	/**
+	 * @brief	The RGB values of every entry in the xterm 256-color palette.
+	 *\n		0-15 are the standard colors as displayed by xterm's default theme, 16-231 are the 6x6x6 color cube, & 232-255 are the grayscale ramp.
+	 */
+	inline constexpr const std::array<RGB, 256> XTERM_PALETTE{ _internal::make_xterm_palette() };
+
+	/**
+	 * @brief			Get the RGB value of a palette index.
+	 * @param index		A color index from 0 to 255.
+	 * @returns			RGB
+	 */
+	inline constexpr RGB palette_to_rgb(const std::uint8_t index) noexcept { return XTERM_PALETTE[index]; }
+
+	/**
+	 * @brief		Get the perceptual distance between two colors, using the "redmean" weighted euclidean approximation.
+	 *\n			This is much cheaper than converting to a perceptual color space, while weighting each channel by how sensitive the eye is to it.
+	 * @param a		Any RGB color.
+	 * @param b		Any RGB color.
+	 * @returns		unsigned	The squared distance. Only useful for comparisons.
+	 */
+	inline constexpr unsigned perceptual_distance(const RGB& a, const RGB& b) noexcept
+	{
+		const int rmean{ (a.r + b.r) / 2 }, dr{ a.r - b.r }, dg{ a.g - b.g }, db{ a.b - b.b };
+		return static_cast<unsigned>((((512 + rmean) * dr * dr) >> 8) + 4 * dg * dg + (((767 - rmean) * db * db) >> 8));
+	}
+
+	/**
+	 * @brief		Find the palette index that is perceptually nearest to an RGB value by searching the palette.
+	 *\n			Prefer rgb_to_256 / rgb_to_16, which use a precomputed lookup table.
+	 * @param color	Any RGB color.
+	 * @param count	The number of palette entries to consider, starting from 0. Use 16 to only consider the standard colors.
+	 * @returns		short
+	 */
+	inline constexpr short nearest_palette_color(const RGB& color, const std::size_t count = 256ull) noexcept
+	{
+		short best{ 0 };
+		unsigned best_distance{ ~0u };
+		for (std::size_t i{ 0ull }; i < count && i < XTERM_PALETTE.size(); ++i) {
+			if (const auto d{ perceptual_distance(color, XTERM_PALETTE[i]) }; d < best_distance) {
+				best = static_cast<short>(i);
+				best_distance = d;
+			}
+		}
+		return best;
+	}
+
+	namespace _internal {
+		/// @brief	The number of bits kept from each channel when indexing the lookup tables.
+		inline constexpr const unsigned LUT_CHANNEL_BITS{ 5u };
+		/// @brief	The number of entries in each lookup table.
+		inline constexpr const std::size_t LUT_SIZE{ 1ull << (LUT_CHANNEL_BITS * 3u) };
+
+		/// @brief	Get the lookup table index of a color packed as 0xRRGGBB.
+		inline constexpr std::uint32_t lut_index(const std::uint32_t packed) noexcept
+		{
+			return ((packed >> 9u) & 0x7C00u) | ((packed >> 6u) & 0x3E0u) | ((packed >> 3u) & 0x1Fu);
+		}
+
+		/**
+		 * @brief		Build a lookup table that maps each quantized color to its nearest palette index.
+		 *\n			Each entry is computed from the center of the range of colors that share its index.
+		 * @param count	The number of palette entries to consider.
+		 */
+		inline std::array<std::uint8_t, LUT_SIZE> make_palette_lut(const std::size_t count)
+		{
+			std::array<std::uint8_t, LUT_SIZE> lut{};
+			for (std::uint32_t i{ 0u }; i < LUT_SIZE; ++i) {
+				const auto center{ [](const std::uint32_t v) { return static_cast<std::uint8_t>((v << 3u) | 4u); } };
+				lut[i] = static_cast<std::uint8_t>(nearest_palette_color(RGB{ center(i >> 10u), center((i >> 5u) & 0x1Fu), center(i & 0x1Fu) }, count));
+			}
+			return lut;
+		}
+
+		/// @brief	Get the lookup table for a color depth. Each table is built the first time it is used.
+		inline const std::uint8_t* palette_lut(const ColorDepth depth)
+		{
+			if (depth == ColorDepth::COLOR_16) {
+				static const auto lut16{ make_palette_lut(16ull) };
+				return lut16.data();
+			}
+			static const auto lut256{ make_palette_lut(256ull) };
+			return lut256.data();
+		}
+	}
+
+	/**
+	 * @brief		Find the 16-color index nearest to an RGB value. Costs one table load.
+	 * @param color	Any RGB color.
+	 * @returns		short	(Range: 0 - 15)
+	 */
+	inline short rgb_to_16(const RGB& color) noexcept
+	{
+		return _internal::palette_lut(ColorDepth::COLOR_16)[_internal::lut_index(color.packed())];
+	}
+
+	/**
+	 * @brief		Find the 256-color index nearest to an RGB value, considering the standard colors, the color cube, & the grayscale ramp. Costs one table load.
+	 * @param color	Any RGB color.
+	 * @returns		short	(Range: 0 - 255)
+	 */
+	inline short rgb_to_256(const RGB& color) noexcept
+	{
+		return _internal::palette_lut(ColorDepth::COLOR_256)[_internal::lut_index(color.packed())];
+	}
+
+	/**
+	 * @brief		Convert an RGB value to the nearest palette index for a color depth.
+	 * @param color	Any RGB color.
+	 * @param depth	The target color depth. Must be COLOR_16 or COLOR_256.
+	 * @returns		short
+	 */
+	inline short downgrade(const RGB& color, const ColorDepth depth) noexcept
+	{
+		return _internal::palette_lut(depth)[_internal::lut_index(color.packed())];
+	}
+
+	/**
+	 * @brief			Convert an array of colors packed as 0xRRGGBB to palette indices. The high byte of each pixel is ignored.
+	 *\n				Table indices are computed 4 pixels at a time with SSE2 or NEON when available.
+	 * @param pixels	Pointer to the first pixel.
+	 * @param out		Pointer to the first output index. Must have room for count elements.
+	 * @param count		The number of pixels to convert.
+	 * @param depth		The target color depth. Must be COLOR_16 or COLOR_256.
+	 */
+	inline void downgrade(const std::uint32_t* pixels, std::uint8_t* out, const std::size_t count, const ColorDepth depth = ColorDepth::COLOR_256) noexcept
+	{
+		const auto* const lut{ _internal::palette_lut(depth) };
+		std::size_t i{ 0ull };
+	#if defined(COLOR_TRANSFORM_SSE2) || defined(COLOR_TRANSFORM_NEON)
+		alignas(16) std::uint32_t indices[4];
+		for (; i + 4ull <= count; i += 4ull) {
+		#ifdef COLOR_TRANSFORM_SSE2
+			const __m128i p{ _mm_loadu_si128(reinterpret_cast<const __m128i*>(pixels + i)) };
+			const __m128i idx{ _mm_or_si128(
+				_mm_or_si128(
+					_mm_and_si128(_mm_srli_epi32(p, 9), _mm_set1_epi32(0x7C00)),
+					_mm_and_si128(_mm_srli_epi32(p, 6), _mm_set1_epi32(0x3E0))
+				),
+				_mm_and_si128(_mm_srli_epi32(p, 3), _mm_set1_epi32(0x1F))
+			) };
+			_mm_store_si128(reinterpret_cast<__m128i*>(indices), idx);
+		#else
+			const uint32x4_t p{ vld1q_u32(pixels + i) };
+			const uint32x4_t idx{ vorrq_u32(
+				vorrq_u32(
+					vandq_u32(vshrq_n_u32(p, 9), vdupq_n_u32(0x7C00u)),
+					vandq_u32(vshrq_n_u32(p, 6), vdupq_n_u32(0x3E0u))
+				),
+				vandq_u32(vshrq_n_u32(p, 3), vdupq_n_u32(0x1Fu))
+			) };
+			vst1q_u32(indices, idx);
+		#endif
+			out[i] = lut[indices[0]];
+			out[i + 1ull] = lut[indices[1]];
+			out[i + 2ull] = lut[indices[2]];
+			out[i + 3ull] = lut[indices[3]];
+		}
+	#endif
+		for (; i < count; ++i)
+			out[i] = lut[_internal::lut_index(pixels[i])];
+	}
+	/**
+	 * @brief			Convert an array of RGB colors to palette indices.
+	 * @param pixels	Pointer to the first pixel.
+	 * @param out		Pointer to the first output index. Must have room for count elements.
+	 * @param count		The number of pixels to convert.
+	 * @param depth		The target color depth. Must be COLOR_16 or COLOR_256.
+	 */
+	inline void downgrade(const RGB* pixels, std::uint8_t* out, const std::size_t count, const ColorDepth depth = ColorDepth::COLOR_256) noexcept
+	{
+		const auto* const lut{ _internal::palette_lut(depth) };
+		for (std::size_t i{ 0ull }; i < count; ++i)
+			out[i] = lut[_internal::lut_index(pixels[i].packed())];
+	}
+}
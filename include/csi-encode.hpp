@@ -0,0 +1,145 @@
+/**
+ * @file	csi-encode.hpp
+ * @author	radj307
+ * @brief	Contains functions for encoding numeric CSI parameters directly into character buffers, without streams or allocations.
+ */
+#pragma once
+#include <array>
+#include <concepts>
+#include <cstddef>
+#include <limits>
+#include <string_view>
+#include <type_traits>
+
+namespace ANSI {
+	namespace _internal {
+		/// @brief	Types that are inserted into a sequence as a single character rather than as a number, mirroring the behaviour of std::ostream.
+		template<typename T>
+		concept sequence_char = std::same_as<T, char> || std::same_as<T, signed char> || std::same_as<T, unsigned char>;
+		/// @brief	Types that are inserted into a sequence as a decimal number.
+		template<typename T>
+		concept sequence_number = (std::integral<T> && !sequence_char<T> && !std::same_as<T, bool>) || std::is_enum_v<T>;
+
+		/// @brief	Lookup table containing the two-character decimal representation of every number from 0 to 99.
+		inline constexpr const char DIGIT_PAIRS[201]{
+			"00010203040506070809"
+			"10111213141516171819"
+			"20212223242526272829"
+			"30313233343536373839"
+			"40414243444546474849"
+			"50515253545556575859"
+			"60616263646566676869"
+			"70717273747576777879"
+			"80818283848586878889"
+			"90919293949596979899"
+		};
+
+		/// @brief	Convert an enum to its underlying type, promoting character-sized types to int so they are encoded as numbers.
+		template<sequence_number T>
+		inline constexpr auto to_param(const T& value) noexcept
+		{
+			if constexpr (std::is_enum_v<T>)
+				return +static_cast<std::underlying_type_t<T>>(value);
+			else return value;
+		}
+	}
+
+	/// @brief	The maximum number of characters required to encode any value of type T, including the sign.
+	template<_internal::sequence_number T>
+	inline constexpr const std::size_t max_param_length_v{ static_cast<std::size_t>(std::numeric_limits<decltype(_internal::to_param(T{})) >::digits10) + 2ull };
+
+	/**
+	 * @brief		Count the number of decimal digits in an unsigned integer.
+	 * @param value	Any unsigned integral value.
+	 * @returns		std::size_t
+	 */
+	template<std::unsigned_integral T>
+	inline constexpr std::size_t count_digits(T value) noexcept
+	{
+		std::size_t count{ 1ull };
+		for (; value >= 10000u; value /= 10000u)
+			count += 4ull;
+		if (value >= 1000u) return count + 3ull;
+		if (value >= 100u) return count + 2ull;
+		if (value >= 10u) return count + 1ull;
+		return count;
+	}
+
+	/**
+	 * @brief		Get the number of characters that encode_param() writes for a given value.
+	 * @param value	Any integral or enum value.
+	 * @returns		std::size_t
+	 */
+	template<_internal::sequence_number T>
+	inline constexpr std::size_t param_length(const T& value) noexcept
+	{
+		const auto v{ _internal::to_param(value) };
+		using P = std::remove_cv_t<decltype(v)>;
+		using U = std::make_unsigned_t<P>;
+		if constexpr (std::is_signed_v<P>)
+			if (v < 0)
+				return 1ull + count_digits(static_cast<U>(U{ 0 } - static_cast<U>(v)));
+		return count_digits(static_cast<U>(v));
+	}
+
+	/**
+	 * @brief		Write the decimal representation of a number into a caller-provided buffer, two digits at a time.
+	 *\n			The buffer must have room for at least param_length(value) characters; max_param_length_v<T> is always enough.
+	 *\n			No null-terminator is written.
+	 * @param out	Pointer to the first character to write.
+	 * @param value	Any integral or enum value.
+	 * @returns		char*	Pointer to one past the last character written.
+	 */
+	template<_internal::sequence_number T>
+	inline constexpr char* encode_param(char* out, const T& value) noexcept
+	{
+		const auto v{ _internal::to_param(value) };
+		using P = std::remove_cv_t<decltype(v)>;
+		using U = std::make_unsigned_t<P>;
+		U n{ static_cast<U>(v) };
+		if constexpr (std::is_signed_v<P>) {
+			if (v < 0) {
+				*out++ = '-';
+				n = static_cast<U>(U{ 0 } - n);
+			}
+		}
+		char* const end{ out + count_digits(n) };
+		char* pos{ end };
+		while (n >= 100u) {
+			const auto i{ static_cast<std::size_t>(n % 100u) * 2ull };
+			n /= 100u;
+			*--pos = _internal::DIGIT_PAIRS[i + 1ull];
+			*--pos = _internal::DIGIT_PAIRS[i];
+		}
+		if (n >= 10u) {
+			const auto i{ static_cast<std::size_t>(n) * 2ull };
+			*--pos = _internal::DIGIT_PAIRS[i + 1ull];
+			*--pos = _internal::DIGIT_PAIRS[i];
+		}
+		else *--pos = static_cast<char>('0' + n);
+		return end;
+	}
+
+	/**
+	 * @struct		static_param
+	 * @brief		Encodes a constant parameter at compile time, so that using it costs only a copy of its characters.
+	 *\n			Example: make_fixed_sequence(ESC, CSI, static_param_v<1049>, ENABLE)
+	 * @tparam Value	Any integral or enum constant.
+	 */
+	template<auto Value> requires _internal::sequence_number<decltype(Value)>
+	struct static_param {
+		static constexpr const std::size_t length{ param_length(Value) };
+		static constexpr const std::array<char, length> characters{ [] {
+			std::array<char, max_param_length_v<decltype(Value)>> buf{};
+			encode_param(buf.data(), Value);
+			std::array<char, length> result{};
+			for (std::size_t i{ 0ull }; i < length; ++i)
+				result[i] = buf[i];
+			return result;
+		}() };
+		static constexpr const std::string_view value{ characters.data(), characters.size() };
+	};
+	/// @brief	The compile-time encoded representation of a constant CSI parameter.
+	template<auto Value>
+	inline constexpr const std::string_view static_param_v{ static_param<Value>::value };
+}
@@ -11,56 +11,56 @@ namespace color {
 	using namespace ANSI;
 	/**
 	 * @brief		Sets all future characters printed to an output stream as bold using ANSI escape sequences.
-	 * @returns		Sequence
+	 * @returns		FixedSequence
 	 */
-	inline constexpr Sequence bold()
+	inline constexpr FixedSequence<> bold()
 	{
-		return Sequence{ make_sequence(ESC, CSI, '1', END) };
+		return make_fixed_sequence(ESC, CSI, '1', END);
 	}
 
 	/**
 	 * @brief		Removes only bold formatting for all future characters printed to an output stream using ANSI escape sequences.
-	 * @returns		Sequence
+	 * @returns		FixedSequence
 	 */
-	inline constexpr Sequence reset_bold()
+	inline constexpr FixedSequence<> reset_bold()
 	{
-		return Sequence{ make_sequence(ESC, CSI, "22", END) };
+		return make_fixed_sequence(ESC, CSI, "22", END);
 	}
 
 	/**
 	 * @brief		Sets all future characters printed to an output stream as underlined using ANSI escape sequences.
-	 * @returns		Sequence
+	 * @returns		FixedSequence
 	 */
-	inline constexpr Sequence underline()
+	inline constexpr FixedSequence<> underline()
 	{
-		return Sequence{ make_sequence(ESC, CSI, '4', END) };
+		return make_fixed_sequence(ESC, CSI, '4', END);
 	}
 
 	/**
 	 * @brief		Removes only underline formatting for all future characters printed to an output stream using ANSI escape sequences.
-	 * @returns		Sequence
+	 * @returns		FixedSequence
 	 */
-	inline constexpr Sequence reset_underline()
+	inline constexpr FixedSequence<> reset_underline()
 	{
-		return Sequence{ make_sequence(ESC, CSI, "24", END) };
+		return make_fixed_sequence(ESC, CSI, "24", END);
 	}
 
 	/**
 	 * @brief		Sets all future characters printed to an output stream as inverted using ANSI escape sequences.
-	 * @returns		Sequence
+	 * @returns		FixedSequence
 	 */
-	inline constexpr Sequence invert()
+	inline constexpr FixedSequence<> invert()
 	{
-		return Sequence{ make_sequence(ESC, CSI, '7', END) };
+		return make_fixed_sequence(ESC, CSI, '7', END);
 	}
 
 	/**
 	 * @brief		Removes only invert formatting for all future characters printed to an output stream using ANSI escape sequences.
-	 * @returns		Sequence
+	 * @returns		FixedSequence
 	 */
-	inline constexpr Sequence reset_invert()
+	inline constexpr FixedSequence<> reset_invert()
 	{
-		return Sequence{ make_sequence(ESC, CSI, "27", END) };
+		return make_fixed_sequence(ESC, CSI, "27", END);
 	}
 
 	/**
@@ -72,16 +72,16 @@ namespace color {
 
 	/**
 	 * @brief		Reset terminal colors to their defaults.
-	 * @returns		Sequence
+	 * @returns		FixedSequence
 	 */
-	inline static const Sequence reset{ make_sequence(ESC, CSI, "38;5;7", END, ESC, CSI, "48;5;0", END) };
+	inline constexpr const FixedSequence<> reset{ make_fixed_sequence(ESC, CSI, "38;5;7", END, ESC, CSI, "48;5;0", END) };
 
 	/**
 	 * @brief		Reset terminal colors to their defaults.
-	 * @returns		Sequence
+	 * @returns		FixedSequence
 	 */
-	inline constexpr Sequence reset_all()
+	inline constexpr FixedSequence<> reset_all()
 	{
-		return Sequence{ make_sequence(ESC, CSI, '0', END) };
+		return make_fixed_sequence(ESC, CSI, '0', END);
 	}
 }
\ No newline at end of file
@@ -0,0 +1,478 @@
+/**
+ * @file	query-engine.hpp
+ * @author	radj307
+ * @brief	Contains the non-blocking query engine used by TermAPIQuery.hpp, which writes a request to the terminal & waits for its reply with a bounded deadline.
+ *\n		On POSIX systems the terminal is switched into raw mode with termios & the reply is read with poll(), so a terminal that never answers can't block the caller.
+ */
+#pragma once
+#include <sysarch.h>
+#include <OutputWriter.hpp>
+
+#include <chrono>
+#include <atomic>
+#include <concepts>
+#include <cstdio>
+#include <functional>
+#include <iostream>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+#ifdef OS_WIN
+#include <conio.h>
+#else
+#include <cerrno>
+#include <poll.h>
+#include <termios.h>
+#include <unistd.h>
+#endif
+
+namespace sys::term {
+	/// @brief	The default amount of time to wait for a terminal to answer a query.
+	inline constexpr std::chrono::microseconds DEFAULT_QUERY_TIMEOUT{ 250'000 };
+
+	/**
+	 * @class	ReplyParser
+	 * @brief	Incremental state machine that recognizes terminal replies in a stream of input bytes, one byte at a time.
+	 *\n		Recognizes CSI (ESC [ ... final), OSC (ESC ] ... BEL/ST), & DCS (ESC P ... ST) replies, including replies that are split across several reads.
+	 *\n		Replies are collected in a fixed-size buffer, so parsing never allocates.
+	 */
+	class ReplyParser {
+	public:
+		/// @brief	The number of bytes that a single reply may contain. Longer replies are discarded.
+		static constexpr std::size_t CAPACITY{ 256ull };
+
+		/// @brief	The type of reply that was recognized.
+		enum class Kind : unsigned char {
+			NONE,
+			CSI,
+			OSC,
+			DCS,
+		};
+		/// @brief	The result of passing a byte to feed().
+		enum class Status : unsigned char {
+			/// @brief	The byte isn't part of a reply. (keyboard input, etc.)
+			GROUND,
+			/// @brief	The byte is part of a reply that isn't complete yet.
+			PENDING,
+			/// @brief	The byte completed a reply, which can be retrieved with sequence() & friends until the next call to feed().
+			COMPLETE,
+			/// @brief	The reply was malformed or too long, & was discarded along with this byte.
+			DISCARDED,
+		};
+
+	private:
+		enum class State : unsigned char {
+			GROUND,
+			ESCAPE,
+			CSI,
+			STRING,			///< @brief Inside of an OSC or DCS string.
+			STRING_ESCAPE,	///< @brief Received ESC inside of an OSC or DCS string, which should be followed by '\' to form ST.
+		};
+
+		char _buffer[CAPACITY]{};
+		std::size_t _size{ 0ull };
+		State _state{ State::GROUND };
+		Kind _kind{ Kind::NONE };
+		bool _complete{ false };
+
+		Status push(const char c) noexcept
+		{
+			if (_size == CAPACITY) {
+				reset();
+				return Status::DISCARDED;
+			}
+			_buffer[_size++] = c;
+			return Status::PENDING;
+		}
+		Status finish() noexcept
+		{
+			_state = State::GROUND;
+			_complete = true;
+			return Status::COMPLETE;
+		}
+
+	public:
+		/// @brief	Discard any partially received reply.
+		void reset() noexcept
+		{
+			_size = 0ull;
+			_state = State::GROUND;
+			_kind = Kind::NONE;
+			_complete = false;
+		}
+
+		/**
+		 * @brief	Pass the next input byte to the state machine.
+		 * @param c	The input byte.
+		 * @returns	Status
+		 */
+		Status feed(const char c) noexcept
+		{
+			if (_complete) { // the previous reply was already handed out
+				_size = 0ull;
+				_kind = Kind::NONE;
+				_complete = false;
+			}
+			const auto uc{ static_cast<unsigned char>(c) };
+			switch (_state) {
+			case State::GROUND:
+				if (c != '\x1b')
+					return Status::GROUND;
+				_state = State::ESCAPE;
+				return push(c);
+			case State::ESCAPE:
+				switch (c) {
+				case '[':
+					_state = State::CSI;
+					_kind = Kind::CSI;
+					return push(c);
+				case ']':
+					_state = State::STRING;
+					_kind = Kind::OSC;
+					return push(c);
+				case 'P':
+					_state = State::STRING;
+					_kind = Kind::DCS;
+					return push(c);
+				default: // not a reply; the escape is most likely a key press
+					reset();
+					return Status::DISCARDED;
+				}
+			case State::CSI:
+				if (uc >= 0x20 && uc <= 0x3F) // parameter & intermediate bytes
+					return push(c);
+				if (uc >= 0x40 && uc <= 0x7E) { // final byte
+					if (const auto status{ push(c) }; status != Status::PENDING)
+						return status;
+					return finish();
+				}
+				reset();
+				return Status::DISCARDED;
+			case State::STRING:
+				if (c == '\a') { // BEL terminates OSC replies from xterm-compatible terminals
+					if (const auto status{ push(c) }; status != Status::PENDING)
+						return status;
+					return finish();
+				}
+				if (c == '\x1b')
+					_state = State::STRING_ESCAPE;
+				return push(c);
+			case State::STRING_ESCAPE:
+				if (c != '\\') {
+					reset();
+					return Status::DISCARDED;
+				}
+				if (const auto status{ push(c) }; status != Status::PENDING)
+					return status;
+				return finish();
+			}
+			return Status::GROUND;
+		}
+
+		/// @brief	Check if a complete reply is available.
+		bool complete() const noexcept { return _complete; }
+		/// @brief	Check if a reply is partially received.
+		bool pending() const noexcept { return !_complete && _state != State::GROUND; }
+		/// @brief	Get the type of the current reply.
+		Kind kind() const noexcept { return _kind; }
+		/// @brief	Get the entire reply, including the introducer & terminator.
+		std::string_view sequence() const noexcept { return{ _buffer, _size }; }
+		/**
+		 * @brief	Get the reply without its introducer & terminator.
+		 *\n		For CSI replies this is the parameter string; ex. "12;40" for the reply "ESC[12;40R".
+		 * @returns	std::string_view
+		 */
+		std::string_view body() const noexcept
+		{
+			if (!_complete)
+				return{};
+			const auto seq{ sequence() };
+			std::size_t terminator{ 1ull };
+			if (_kind != Kind::CSI && seq.back() == '\\')
+				terminator = 2ull;
+			return seq.substr(2ull, seq.size() - 2ull - terminator);
+		}
+		/// @brief	Get the final byte of a CSI reply, or the terminating character of a string reply.
+		char final_byte() const noexcept { return _size == 0ull ? '\0' : _buffer[_size - 1ull]; }
+	};
+
+	/**
+	 * @class	RawMode
+	 * @brief	RAII wrapper that switches a terminal into non-canonical, non-echoing mode for its lifetime.
+	 *\n		This prevents terminal replies from being echoed to the screen or held back until the user presses enter.
+	 *\n		Does nothing on Windows, where the console doesn't line-buffer replies.
+	 */
+	class RawMode {
+	#ifndef OS_WIN
+		termios _saved{};
+		int _fd;
+	#endif
+		bool _active{ false };
+
+	public:
+		/**
+		 * @brief		Constructor
+		 * @param fd	The file descriptor of the terminal's input.
+		 */
+	#ifdef OS_WIN
+		explicit RawMode(const int = 0) noexcept : _active{ true } {}
+	#else
+		explicit RawMode(const int fd = STDIN_FILENO) noexcept : _fd{ fd }
+		{
+			if (!isatty(_fd) || tcgetattr(_fd, &_saved) != 0)
+				return;
+			termios raw{ _saved };
+			raw.c_lflag &= ~static_cast<tcflag_t>(ICANON | ECHO);
+			raw.c_cc[VMIN] = 0;
+			raw.c_cc[VTIME] = 0;
+			_active = tcsetattr(_fd, TCSANOW, &raw) == 0;
+		}
+		~RawMode() noexcept
+		{
+			if (_active)
+				tcsetattr(_fd, TCSANOW, &_saved);
+		}
+	#endif
+		RawMode(const RawMode&) = delete;
+		RawMode& operator=(const RawMode&) = delete;
+
+		/// @brief	Check if the terminal is in raw mode. This is false when the file descriptor isn't a terminal.
+		bool active() const noexcept { return _active; }
+	};
+
+	namespace _internal {
+		/**
+		 * @brief			Write a query request to the terminal, after any output that is still buffered.
+		 * @param request	The request to write.
+		 * @returns			bool	false when the write failed.
+		 */
+		inline bool write_query_request(std::string_view request) noexcept
+		{
+			std::cout.flush();
+			getOutputWriter().flush();
+			fflush(stdout);
+			while (!request.empty()) {
+			#ifdef OS_WIN
+				const auto count{ static_cast<long long>(fwrite(request.data(), 1ull, request.size(), stdout)) };
+				fflush(stdout);
+				if (count <= 0)
+					return false;
+			#else
+				const auto count{ ::write(STDOUT_FILENO, request.data(), request.size()) };
+				if (count < 0) {
+					if (errno == EINTR)
+						continue;
+					return false;
+				}
+			#endif
+				request.remove_prefix(static_cast<std::size_t>(count));
+			}
+			return true;
+		}
+
+		/**
+		 * @brief			Wait until input is available or the deadline passes.
+		 * @param deadline	The point in time after which to stop waiting.
+		 * @returns			bool	true when input is available.
+		 */
+		inline bool wait_for_input(const std::chrono::steady_clock::time_point& deadline) noexcept
+		{
+			for (;;) {
+				const auto remaining{ std::chrono::duration_cast<std::chrono::microseconds>(deadline - std::chrono::steady_clock::now()) };
+				if (remaining.count() <= 0)
+					return false;
+			#ifdef OS_WIN
+				if (_kbhit())
+					return true;
+				std::this_thread::sleep_for(std::min(remaining, std::chrono::microseconds{ 1000 }));
+			#else
+				pollfd fd{ STDIN_FILENO, POLLIN, 0 };
+				// poll() only accepts milliseconds, so round up to avoid spinning on the last fraction of a millisecond
+				const auto timeout_ms{ static_cast<int>((remaining.count() + 999ll) / 1000ll) };
+				const auto result{ poll(&fd, 1, timeout_ms) };
+				if (result > 0)
+					return (fd.revents & POLLIN) != 0;
+				if (result < 0 && errno != EINTR)
+					return false;
+			#endif
+			}
+		}
+
+		/**
+		 * @brief			Read whatever input is immediately available without blocking.
+		 * @param buffer	Receives the input.
+		 * @param size		The size of the buffer.
+		 * @returns			std::size_t	The number of bytes that were read.
+		 */
+		inline std::size_t read_available(char* buffer, const std::size_t size) noexcept
+		{
+		#ifdef OS_WIN
+			std::size_t count{ 0ull };
+			while (count < size && _kbhit())
+				buffer[count++] = static_cast<char>(_getch());
+			return count;
+		#else
+			for (;;) {
+				const auto count{ ::read(STDIN_FILENO, buffer, size) };
+				if (count >= 0)
+					return static_cast<std::size_t>(count);
+				if (errno != EINTR)
+					return 0ull;
+			}
+		#endif
+		}
+	}
+
+	/**
+	 * @brief			Read terminal replies until one is accepted by the predicate, or the deadline passes.
+	 *\n				The terminal should already be in raw mode; see RawMode.
+	 *\n				Input that isn't part of an accepted reply is discarded.
+	 * @param parser	The parser to feed input to. When a reply is accepted, it remains available from the parser.
+	 * @param accept	Predicate that receives the parser each time it completes a reply, & returns true when it is the expected reply.
+	 * @param deadline	The point in time after which to stop waiting.
+	 * @returns			bool	true when a reply was accepted, false when the deadline passed first.
+	 */
+	template<typename Predicate> requires std::predicate<Predicate, const ReplyParser&>
+	inline bool read_query_reply(ReplyParser& parser, const Predicate& accept, const std::chrono::steady_clock::time_point& deadline)
+	{
+		// replies are read one byte at a time so that input following the reply is left unread
+		char c;
+		while (_internal::wait_for_input(deadline)) {
+			if (_internal::read_available(&c, 1ull) == 0ull)
+				continue;
+			if (parser.feed(c) == ReplyParser::Status::COMPLETE && accept(parser))
+				return true;
+		}
+		return false;
+	}
+
+	/**
+	 * @class	QueryRouter
+	 * @brief	Interface for an object that owns the terminal's input, such as InputRouter.
+	 *\n		While one is registered with setQueryRouter(), query() hands requests to it instead of reading STDIN directly.
+	 */
+	struct QueryRouter {
+		using predicate_type = std::function<bool(const ReplyParser&)>;
+		virtual ~QueryRouter() = default;
+		/**
+		 * @brief			Send a query request & wait for the reply that is accepted by the predicate.
+		 * @param request	The query escape sequence to send.
+		 * @param accept	Predicate that receives each unclaimed reply, & returns true when it is the reply to this request.
+		 * @param timeout	The maximum amount of time to wait for the reply.
+		 * @returns			std::optional<std::string>	The complete reply, or std::nullopt when the terminal didn't answer in time.
+		 */
+		virtual std::optional<std::string> route_query(std::string_view request, predicate_type accept, std::chrono::microseconds timeout) = 0;
+		/**
+		 * @brief					Send several query requests in a single write, & wait for all of their replies within one deadline.
+		 * @param requests			The concatenated query escape sequences.
+		 * @param accept			One predicate per query, in the order that the requests were written.
+		 * @param timeout			The maximum amount of time to wait for all of the replies.
+		 * @param last_is_sentinel	When true, stop waiting as soon as the last query is answered; terminals answer in order, so earlier queries that weren't answered by then are unsupported.
+		 * @returns					std::vector<std::optional<std::string>>	One reply per predicate, or std::nullopt for queries that weren't answered.
+		 */
+		virtual std::vector<std::optional<std::string>> route_batch(std::string_view requests, const std::vector<predicate_type>& accept, std::chrono::microseconds timeout, bool last_is_sentinel) = 0;
+	};
+
+	namespace _internal {
+		inline std::atomic<QueryRouter*> query_router{ nullptr };
+	}
+
+	/**
+	 * @brief			Register the object that owns the terminal's input, which receives all subsequent queries. The router must outlive every query that it receives.
+	 * @param router	The new router, or nullptr to go back to reading STDIN directly.
+	 * @returns			QueryRouter*	The previous router.
+	 */
+	inline QueryRouter* setQueryRouter(QueryRouter* router) noexcept
+	{
+		return _internal::query_router.exchange(router, std::memory_order_acq_rel);
+	}
+	/// @brief	Get the router that currently receives queries, or nullptr when queries read STDIN directly.
+	inline QueryRouter* getQueryRouter() noexcept
+	{
+		return _internal::query_router.load(std::memory_order_acquire);
+	}
+
+	/**
+	 * @brief			Send a query request to the terminal & wait for the reply. Latency is bounded by the timeout even when the terminal never answers.
+	 * @param request	The query escape sequence to send.
+	 * @param accept	Predicate that receives a ReplyParser each time a reply is completed, & returns true when it is the reply to this request.
+	 * @param timeout	The maximum amount of time to wait for the reply.
+	 * @returns			std::optional<std::string>	The complete reply, or std::nullopt when STDIN isn't a terminal or the terminal didn't answer in time.
+	 */
+	template<typename Predicate> requires std::predicate<Predicate, const ReplyParser&>
+	inline std::optional<std::string> query(const std::string_view& request, const Predicate& accept, const std::chrono::microseconds& timeout = DEFAULT_QUERY_TIMEOUT)
+	{
+		if (auto* router{ getQueryRouter() }; router != nullptr)
+			return router->route_query(request, accept, timeout);
+		const RawMode raw;
+		if (!raw.active() || !_internal::write_query_request(request))
+			return std::nullopt;
+		ReplyParser parser;
+		if (!read_query_reply(parser, accept, std::chrono::steady_clock::now() + timeout))
+			return std::nullopt;
+		return std::string{ parser.sequence() };
+	}
+	/**
+	 * @brief			Send a query request to the terminal & wait for the first CSI reply that ends with the given final byte.
+	 * @param request	The query escape sequence to send.
+	 * @param final_char	The final byte of the expected reply; ex. 'R' for a cursor position report.
+	 * @param timeout	The maximum amount of time to wait for the reply.
+	 * @returns			std::optional<std::string>	The complete reply, or std::nullopt when the terminal didn't answer in time.
+	 */
+	inline std::optional<std::string> query(const std::string_view& request, const char final_char, const std::chrono::microseconds& timeout = DEFAULT_QUERY_TIMEOUT)
+	{
+		return query(request, [final_char](const ReplyParser& p) { return p.kind() == ReplyParser::Kind::CSI && p.final_byte() == final_char; }, timeout);
+	}
+
+	/**
+	 * @struct	BatchQuery
+	 * @brief	One query in a batch; see query_batch().
+	 */
+	struct BatchQuery {
+		/// @brief	The query escape sequence.
+		std::string request;
+		/// @brief	Predicate that receives each unclaimed reply, & returns true when it is the reply to this query.
+		QueryRouter::predicate_type accept;
+	};
+
+	/**
+	 * @brief					Send several queries in a single write & collect all of their replies within one deadline, so the batch costs one round trip instead of one per query.
+	 *\n						Each reply is given to the earliest unanswered query that accepts it.
+	 * @param queries			The queries to send, in order.
+	 * @param timeout			The maximum amount of time to wait for all of the replies.
+	 * @param last_is_sentinel	When true, stop waiting as soon as the last query is answered. Terminals answer in order, so putting a query that every terminal answers (such as DA1) last
+	 *\n						avoids waiting for the full timeout when some of the other queries are unsupported.
+	 * @returns					std::vector<std::optional<std::string>>	One reply per query, or std::nullopt for queries that weren't answered.
+	 */
+	inline std::vector<std::optional<std::string>> query_batch(const std::vector<BatchQuery>& queries, const std::chrono::microseconds& timeout = DEFAULT_QUERY_TIMEOUT, const bool last_is_sentinel = true)
+	{
+		std::string requests;
+		std::vector<QueryRouter::predicate_type> accept;
+		accept.reserve(queries.size());
+		for (const auto& q : queries) {
+			requests += q.request;
+			accept.emplace_back(q.accept);
+		}
+		if (auto* router{ getQueryRouter() }; router != nullptr)
+			return router->route_batch(requests, accept, timeout, last_is_sentinel);
+
+		std::vector<std::optional<std::string>> replies(queries.size());
+		const RawMode raw;
+		if (queries.empty() || !raw.active() || !_internal::write_query_request(requests))
+			return replies;
+		std::size_t remaining{ queries.size() };
+		ReplyParser parser;
+		read_query_reply(parser, [&](const ReplyParser& p) {
+			for (std::size_t i{ 0ull }; i < accept.size(); ++i) {
+				if (!replies[i].has_value() && accept[i](p)) {
+					replies[i] = std::string{ p.sequence() };
+					return --remaining == 0ull || (last_is_sentinel && i + 1ull == accept.size());
+				}
+			}
+			return false;
+		}, std::chrono::steady_clock::now() + timeout);
+		return replies;
+	}
+}
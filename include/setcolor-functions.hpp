@@ -8,7 +8,10 @@ namespace color {
 	 * @brief Foreground colorization functions.
 	 */
 	namespace foreground {
-		struct setcolor : color::setcolor { setcolor(const short color) : color::setcolor(color, Layer::FOREGROUND) {} };
+		struct setcolor : color::setcolor {
+			setcolor(const short color) : color::setcolor(color, Layer::FOREGROUND) {}
+			setcolor(const RGB& color) : color::setcolor(color, Layer::FOREGROUND) {}
+		};
 
 		inline std::ostream& red(std::ostream& os) { os << setcolor(color::red); return os; }
 		inline std::ostream& green(std::ostream& os) { os << setcolor(color::green); return os; }
@@ -28,7 +31,10 @@ namespace color {
 	 * @brief Background colorization functions.
 	 */
 	namespace background {
-		struct setcolor : color::setcolor { setcolor(const short color) : color::setcolor(color, Layer::BACKGROUND) {} };
+		struct setcolor : color::setcolor {
+			setcolor(const short color) : color::setcolor(color, Layer::BACKGROUND) {}
+			setcolor(const RGB& color) : color::setcolor(color, Layer::BACKGROUND) {}
+		};
 
 		inline std::ostream& red(std::ostream& os) { os << setcolor(color::red); return os; }
 		inline std::ostream& green(std::ostream& os) { os << setcolor(color::green); return os; }
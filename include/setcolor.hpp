@@ -7,20 +7,39 @@
 #include <format-functions.hpp>
 #include <FormatFlag.hpp>
 #include <Layer.hpp>
+#include <RenditionState.hpp>
+#include <color-sequence-table.hpp>
+#include <color-transform.hpp>
 #include <sstream>
 namespace color {
 	/**
 	 * @brief Builds the escape sequence needed to change console colors.
+	 *\n	Colors in the 256-color range are copied from the precomputed table in color-sequence-table.hpp.
 	 * @param color			- The color value to set.
-	 * @param foreground	- When true, changes the color of the foreground (text) instead of the background.
+	 * @param layer			- Which layer to apply the color to.
 	 * @returns std::string
 	 */
 	inline std::string makeColorSequence(const short& color, const Layer& layer)
 	{
-		std::stringstream ss;
 		using namespace ANSI;
-		ss << ESC << CSI << layer << ';' << color << END;
-		return ss.str();
+		if (color >= 0 && color <= 255) {
+			if (layer._layer == FORE)
+				return std::string{ color_sequence(static_cast<unsigned char>(color), true) };
+			if (layer._layer == BACK)
+				return std::string{ color_sequence(static_cast<unsigned char>(color), false) };
+		}
+		return make_sequence(ESC, CSI, layer._layer, ';', color, END);
+	}
+	/**
+	 * @brief Builds the 24-bit escape sequence needed to change console colors.
+	 * @param color			- The RGB color value to set.
+	 * @param layer			- Which layer to apply the color to.
+	 * @returns std::string
+	 */
+	inline std::string makeColorSequence(const RGB& color, const Layer& layer)
+	{
+		using namespace ANSI;
+		return make_sequence(ESC, CSI, (layer._layer == BACK ? BACK_RGB : FORE_RGB), ';', +color.r, ';', +color.g, ';', +color.b, END);
 	}
 
 	/**
@@ -33,6 +52,19 @@ namespace color {
 	private:
 		std::string _seq; ///< @brief The escape sequence to set colors.
 		ColorFormat _format; ///< @brief Stores information about bold/underline/invert
+		short _color{ RenditionState::UNKNOWN }; ///< @brief The color index, or RenditionState::UNKNOWN when _seq is a custom escape sequence.
+		bool _is_foreground{ true }; ///< @brief When true, _color applies to the foreground layer.
+		std::uint32_t _rgb{ NO_RGB }; ///< @brief The packed 24-bit color, or NO_RGB when this isn't a truecolor setter.
+
+		static constexpr const std::uint32_t NO_RGB{ ~0u };
+
+		/// @brief	Resolve the palette index to emit, downgrading the 24-bit color when the color depth requires it.
+		short resolveColor(const ColorDepth depth) const noexcept
+		{
+			if (_rgb == NO_RGB)
+				return _color;
+			return downgrade(RGB{ _rgb }, depth);
+		}
 
 	public:
 		/**
@@ -41,19 +73,33 @@ namespace color {
 		 * @param layer			Which layer to apply the color to. (FOREGROUND/BACKGROUND)
 		 * @param format		Which format flags to apply, if any. You can use the bitwise OR operator to combine multiple flags.
 		 */
-		setcolor(const short color, const Layer layer = Layer::FOREGROUND, const FormatFlag& format = FormatFlag::NONE) : _seq{ std::move(makeColorSequence(color, layer)) }, _format{ format } {}
+		setcolor(const short color, const Layer layer = Layer::FOREGROUND, const FormatFlag& format = FormatFlag::NONE) : _seq{ std::move(makeColorSequence(color, layer)) }, _format{ format }, _color{ color }, _is_foreground{ layer._layer != Layer::BACKGROUND._layer } {}
 		/**
 		 * @brief				Constructor that automatically generates an escape sequence with the given parameters, but always applies the color to the foreground.
 		 * @param color			A number within the terminal's color range. (up to 255)
 		 * @param format		Which format flags to apply, if any. You can use the bitwise OR operator to combine multiple flags.
 		 */
-		setcolor(const short color, const FormatFlag format) : _seq{ std::move(makeColorSequence(color, Layer::FOREGROUND)) }, _format{ format } {}
+		setcolor(const short color, const FormatFlag format) : _seq{ std::move(makeColorSequence(color, Layer::FOREGROUND)) }, _format{ format }, _color{ color } {}
 		/**
 		 * @brief				Constructor that accepts an escape sequence string.
 		 * @param color_seq		The full ANSI escape sequence, stored in a string variable. This is simply inserted into whichever output stream you target.
 		 * @param format		Which format flags to apply, if any. You can use the bitwise OR operator to combine multiple flags.
 		 */
 		setcolor(std::string color_seq, const FormatFlag& format = FormatFlag::NONE) : _seq{ std::move(color_seq) }, _format{ format } {}
+		/**
+		 * @brief				Constructor for 24-bit colors.
+		 *\n					When color_settings::colorDepth is less than TRUECOLOR at the time the color is inserted, the nearest palette index is emitted instead.
+		 * @param color			Any RGB color.
+		 * @param layer			Which layer to apply the color to. (FOREGROUND/BACKGROUND)
+		 * @param format		Which format flags to apply, if any. You can use the bitwise OR operator to combine multiple flags.
+		 */
+		setcolor(const RGB& color, const Layer layer = Layer::FOREGROUND, const FormatFlag& format = FormatFlag::NONE) : _seq{ std::move(makeColorSequence(color, layer)) }, _format{ format }, _is_foreground{ layer._layer != Layer::BACKGROUND._layer }, _rgb{ color.packed() } {}
+		/**
+		 * @brief				Constructor for 24-bit colors that always applies the color to the foreground.
+		 * @param color			Any RGB color.
+		 * @param format		Which format flags to apply, if any. You can use the bitwise OR operator to combine multiple flags.
+		 */
+		setcolor(const RGB& color, const FormatFlag format) : setcolor(color, Layer::FOREGROUND, format) {}
 
 		/**
 		 * @brief		Retrieve the escape sequence as a string.
@@ -79,25 +125,64 @@ namespace color {
 		virtual bool operator==(const setcolor& o) const;
 		virtual bool operator!=(const setcolor& o) const;
 
-		// Output Stream insertion operator
-		friend std::ostream& operator<<(std::ostream& os, const setcolor& obj)
+		/**
+		 * @brief			Insert this color into an output stream or writer through a rendition tracker.
+		 *\n				Attributes that are already active according to the tracker are skipped, and the rest are merged into a single sequence.
+		 *\n				Custom & 24-bit escape sequences are always inserted, and are used to update the tracker.
+		 *\n				When the color depth is COLOR_16, colors 0-15 are set with SGR 30-37/90-97 or 40-47/100-107.
+		 * @param out		Any output stream or OutputWriter.
+		 * @param state		The rendition tracker associated with the output.
+		 * @param depth		The color depth to render the color for.
+		 * @returns			Target&
+		 */
+		template<typename Target>
+		Target& write(Target& out, RenditionState& state, const ColorDepth depth) const
 		{
-			os << obj._seq;
-			if (obj._format != FormatFlag::NONE) {
-				if (obj._format == FormatFlag::BOLD)
-					os << bold();
-				if (obj._format == FormatFlag::RESET_BOLD)
-					os << reset_bold();
-				if (obj._format == FormatFlag::UNDERLINE)
-					os << underline();
-				if (obj._format == FormatFlag::RESET_UNDERLINE)
-					os << reset_underline();
-				if (obj._format == FormatFlag::INVERT)
-					os << invert();
-				if (obj._format == FormatFlag::RESET_INVERT)
-					os << reset_invert();
+			const auto color{ (_rgb != NO_RGB && depth == ColorDepth::TRUECOLOR) ? RenditionState::UNKNOWN : resolveColor(depth) };
+			if (color == RenditionState::UNKNOWN && !_seq.empty()) {
+				out << std::string_view{ _seq };
+				state.observe(_seq);
 			}
-			return os;
+			const unsigned char fmt{ _format };
+			const auto seq{ state.transition(
+				(color != RenditionState::UNKNOWN && _is_foreground) ? color : RenditionState::UNKNOWN,
+				(color != RenditionState::UNKNOWN && !_is_foreground) ? color : RenditionState::UNKNOWN,
+				static_cast<unsigned char>(fmt & RenditionState::ALL_FLAGS),
+				static_cast<unsigned char>((fmt >> 1) & RenditionState::ALL_FLAGS), // RESET_ flags are one bit above their counterparts
+				depth == ColorDepth::COLOR_16
+			) };
+			out << seq.view();
+			return out;
+		}
+		/**
+		 * @brief			Insert this color into an output stream or writer through a rendition tracker, using the current color depth.
+		 * @param out		Any output stream or OutputWriter.
+		 * @param state		The rendition tracker associated with the output.
+		 * @returns			Target&
+		 */
+		template<typename Target>
+		Target& write(Target& out, RenditionState& state) const { return write(out, state, getColorDepth()); }
+
+		// Output Stream insertion operator. Uses the stream's RenditionState when it is tracked.
+		friend std::ostream& operator<<(std::ostream& os, const setcolor& obj)
+		{
+			if (auto* state{ RenditionState::get(os) }; state != nullptr)
+				return obj.write(os, *state);
+			RenditionState untracked;
+			return obj.write(os, untracked);
+		}
+		// Output writer insertion operator
+		friend sys::term::OutputWriter& operator<<(sys::term::OutputWriter& w, const setcolor& obj)
+		{
+			RenditionState untracked;
+			return obj.write(w, untracked);
+		}
+		/// @brief	Prints this color sequence to STDOUT through the calling thread's OutputWriter.
+		void operator()() const
+		{
+			auto& writer{ sys::term::getOutputWriter() };
+			writer << *this;
+			writer.commit();
 		}
 	};
 	/// @brief This setcolor instance can be used as a placeholder, when operator<< is called, nothing will be inserted. (Note that operator<< will still cause certain stream flags/facets to be reset!)
@@ -0,0 +1,333 @@
+/**
+ * @file	xlog-async.hpp
+ * @author	radj307
+ * @brief	Contains the asynchronous backend for xlog: a bounded lock-free queue, & the AsyncLogWriter that drains it on a background thread.
+ */
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+
+namespace xlog {
+	/**
+	 * @class		BoundedQueue
+	 * @brief		Bounded lock-free queue based on Dmitry Vyukov's array queue. Each cell carries a sequence number, so producers & consumers only contend on their own index.
+	 *\n			Any number of threads may push & pop concurrently; xlog uses it with many producers and a single consumer, plus producers that evict the oldest record.
+	 * @tparam T	The element type. Must be default-constructible & move-assignable.
+	 */
+	template<typename T>
+	class BoundedQueue {
+		struct Cell {
+			std::atomic<std::size_t> sequence;
+			T value;
+		};
+
+		std::unique_ptr<Cell[]> _cells;
+		std::size_t _mask;
+		alignas(64) std::atomic<std::size_t> _head{ 0ull };	///< @brief Next position to push to.
+		alignas(64) std::atomic<std::size_t> _tail{ 0ull };	///< @brief Next position to pop from.
+
+		static constexpr std::size_t round_up(const std::size_t n) noexcept
+		{
+			std::size_t v{ 2ull };
+			while (v < n)
+				v <<= 1u;
+			return v;
+		}
+
+	public:
+		/**
+		 * @brief			Constructor
+		 * @param capacity	The minimum number of elements the queue can hold. Rounded up to a power of two.
+		 */
+		explicit BoundedQueue(const std::size_t capacity) : _cells{ new Cell[round_up(capacity)] }, _mask{ round_up(capacity) - 1ull }
+		{
+			for (std::size_t i{ 0ull }; i <= _mask; ++i)
+				_cells[i].sequence.store(i, std::memory_order_relaxed);
+		}
+
+		/// @brief	Get the number of elements the queue can hold.
+		std::size_t capacity() const noexcept { return _mask + 1ull; }
+
+		/**
+		 * @brief		Push an element if the queue isn't full.
+		 * @param value	The element to push. Only moved from when the push succeeds.
+		 * @returns		bool	false when the queue is full.
+		 */
+		bool try_push(T& value)
+		{
+			Cell* cell;
+			auto pos{ _head.load(std::memory_order_relaxed) };
+			for (;;) {
+				cell = &_cells[pos & _mask];
+				const auto diff{ static_cast<std::intptr_t>(cell->sequence.load(std::memory_order_acquire)) - static_cast<std::intptr_t>(pos) };
+				if (diff == 0) {
+					if (_head.compare_exchange_weak(pos, pos + 1ull, std::memory_order_relaxed))
+						break;
+				}
+				else if (diff < 0)
+					return false;
+				else pos = _head.load(std::memory_order_relaxed);
+			}
+			cell->value = std::move(value);
+			cell->sequence.store(pos + 1ull, std::memory_order_release);
+			return true;
+		}
+
+		/**
+		 * @brief		Pop the oldest element if the queue isn't empty.
+		 * @param out	Receives the element.
+		 * @returns		bool	false when the queue is empty.
+		 */
+		bool try_pop(T& out)
+		{
+			Cell* cell;
+			auto pos{ _tail.load(std::memory_order_relaxed) };
+			for (;;) {
+				cell = &_cells[pos & _mask];
+				const auto diff{ static_cast<std::intptr_t>(cell->sequence.load(std::memory_order_acquire)) - static_cast<std::intptr_t>(pos + 1ull) };
+				if (diff == 0) {
+					if (_tail.compare_exchange_weak(pos, pos + 1ull, std::memory_order_relaxed))
+						break;
+				}
+				else if (diff < 0)
+					return false;
+				else pos = _tail.load(std::memory_order_relaxed);
+			}
+			out = std::move(cell->value);
+			cell->sequence.store(pos + _mask + 1ull, std::memory_order_release);
+			return true;
+		}
+	};
+
+	/**
+	 * @enum	OverflowPolicy
+	 * @brief	Determines what happens when a log record is pushed while the asynchronous queue is full.
+	 */
+	enum class OverflowPolicy : unsigned char {
+		/// @brief	Wait until the background thread makes room.
+		BLOCK,
+		/// @brief	Discard the record that is being pushed.
+		DROP_NEWEST,
+		/// @brief	Discard the oldest queued record to make room.
+		DROP_OLDEST,
+	};
+
+	/**
+	 * @struct	AsyncOptions
+	 * @brief	Settings for asynchronous logging.
+	 */
+	struct AsyncOptions {
+		/// @brief	The number of records that can be queued. Rounded up to a power of two.
+		std::size_t capacity{ 1024ull };
+		/// @brief	What to do when the queue is full.
+		OverflowPolicy policy{ OverflowPolicy::BLOCK };
+	};
+
+	/**
+	 * @struct	LogRecord
+	 * @brief	A message that was accepted by the log level filter, waiting to be formatted & written.
+	 */
+	struct LogRecord {
+		unsigned char level{ 0u };
+		std::string message;
+	};
+
+	/**
+	 * @class	AsyncLogWriter
+	 * @brief	Moves formatting & writing of log records off of the calling threads.
+	 *\n		Producers push records into a BoundedQueue without locking; a single background thread pops them & passes them to the sink.
+	 */
+	class AsyncLogWriter {
+	public:
+		using sink_type = std::function<void(const LogRecord&)>;
+
+	private:
+		BoundedQueue<LogRecord> _queue;
+		const OverflowPolicy _policy;
+		const sink_type _sink;
+		std::atomic<std::uint64_t> _enqueued{ 0ull };	///< @brief The number of records that were pushed.
+		std::atomic<std::uint64_t> _retired{ 0ull };	///< @brief The number of records that were written or evicted.
+		std::atomic<std::uint64_t> _dropped{ 0ull };	///< @brief The number of records that were discarded by the overflow policy.
+		std::atomic<std::uint32_t> _wake{ 0u };			///< @brief Incremented to wake the background thread.
+		std::atomic<bool> _stop{ false };
+		std::thread _worker;
+
+		void wake() noexcept
+		{
+			_wake.fetch_add(1u, std::memory_order_release);
+			_wake.notify_one();
+		}
+		void retire(const std::uint64_t count = 1ull) noexcept
+		{
+			_retired.fetch_add(count, std::memory_order_release);
+			_retired.notify_all();
+		}
+
+		void run()
+		{
+			LogRecord record;
+			for (;;) {
+				const auto wake_count{ _wake.load(std::memory_order_acquire) };
+				while (_queue.try_pop(record)) {
+					try {
+						_sink(record);
+					} catch (...) {} // a failing sink must not take down the logging thread
+					retire();
+				}
+				if (_stop.load(std::memory_order_acquire)) // records can't be pushed after shutdown() was called, so the queue stays empty
+					return;
+				_wake.wait(wake_count, std::memory_order_acquire);
+			}
+		}
+
+	public:
+		/**
+		 * @brief			Constructor. Starts the background thread.
+		 * @param sink		Called on the background thread with each record, in order.
+		 * @param options	Queue capacity & overflow policy.
+		 */
+		AsyncLogWriter(sink_type sink, const AsyncOptions& options = {}) : _queue{ options.capacity }, _policy{ options.policy }, _sink{ std::move(sink) }, _worker{ &AsyncLogWriter::run, this } {}
+		AsyncLogWriter(const AsyncLogWriter&) = delete;
+		AsyncLogWriter& operator=(const AsyncLogWriter&) = delete;
+		/// @brief	Destructor. Writes every queued record, then stops the background thread.
+		~AsyncLogWriter() { shutdown(); }
+
+		/**
+		 * @brief			Queue a record according to the overflow policy.
+		 * @param record	The record to queue.
+		 * @returns			bool	false when the record was dropped.
+		 */
+		bool push(LogRecord&& record)
+		{
+			for (;;) {
+				const auto retired{ _retired.load(std::memory_order_acquire) };
+				if (_queue.try_push(record))
+					break;
+				if (_policy == OverflowPolicy::DROP_NEWEST) {
+					_dropped.fetch_add(1ull, std::memory_order_relaxed);
+					return false;
+				}
+				if (_policy == OverflowPolicy::DROP_OLDEST) {
+					if (LogRecord victim; _queue.try_pop(victim)) {
+						_dropped.fetch_add(1ull, std::memory_order_relaxed);
+						retire();
+					}
+				}
+				else { // BLOCK
+					wake();
+					_retired.wait(retired, std::memory_order_acquire);
+				}
+			}
+			_enqueued.fetch_add(1ull, std::memory_order_release);
+			wake();
+			return true;
+		}
+
+		/// @brief	Block until every record that was pushed before this call has been written or dropped.
+		void flush()
+		{
+			const auto target{ _enqueued.load(std::memory_order_acquire) };
+			for (auto retired{ _retired.load(std::memory_order_acquire) }; retired < target; retired = _retired.load(std::memory_order_acquire)) {
+				wake();
+				_retired.wait(retired, std::memory_order_acquire);
+			}
+		}
+
+		/// @brief	Write every queued record, then stop the background thread. Records must not be pushed during or after shutdown.
+		void shutdown()
+		{
+			if (!_worker.joinable())
+				return;
+			_stop.store(true, std::memory_order_release);
+			wake();
+			_worker.join();
+		}
+
+		/// @brief	Get the number of records that were discarded by the overflow policy.
+		std::uint64_t droppedCount() const noexcept { return _dropped.load(std::memory_order_relaxed); }
+		/// @brief	Get the overflow policy.
+		OverflowPolicy policy() const noexcept { return _policy; }
+		/// @brief	Get the queue capacity.
+		std::size_t capacity() const noexcept { return _queue.capacity(); }
+	};
+
+	/**
+	 * @class	AsyncWriterSlot
+	 * @brief	Holds the AsyncLogWriter of a logger that can be switched between synchronous & asynchronous mode while other threads are logging.
+	 *\n		Threads that use the writer only touch atomic counters. Each user is counted under the current epoch; removing the writer advances the epoch
+	 *\n		& waits until the users counted under the previous epochs are done, so it can't be starved by threads that keep logging.
+	 */
+	class AsyncWriterSlot {
+		std::atomic<AsyncLogWriter*> _writer{ nullptr };
+		std::atomic<unsigned> _epoch{ 0u };
+		mutable std::atomic<std::uint64_t> _users[2]{ 0ull, 0ull };
+		std::mutex _mutex; ///< @brief Serializes emplace & reset.
+
+		/// @brief	Wait until every user counted under an epoch is done. Only threads that read the epoch before it was advanced can still be counted under it.
+		void drain(const unsigned epoch) const noexcept
+		{
+			while (_users[epoch].load() != 0ull)
+				std::this_thread::yield();
+		}
+
+	public:
+		AsyncWriterSlot() = default;
+		AsyncWriterSlot(const AsyncWriterSlot&) = delete;
+		AsyncWriterSlot& operator=(const AsyncWriterSlot&) = delete;
+		/// @brief	Destructor. Calls reset().
+		~AsyncWriterSlot() { reset(); }
+
+		/**
+		 * @brief			Start a writer, unless one is already running.
+		 * @param sink		Called on the background thread with each record, in order.
+		 * @param options	Queue capacity & overflow policy.
+		 * @returns			bool	false if a writer was already running.
+		 */
+		bool emplace(AsyncLogWriter::sink_type sink, const AsyncOptions& options)
+		{
+			std::scoped_lock lock(_mutex);
+			if (_writer.load() != nullptr)
+				return false;
+			_writer.store(new AsyncLogWriter{ std::move(sink), options });
+			return true;
+		}
+		/// @brief	Stop & destroy the writer after the threads that are using it are done, writing every record they pushed. Does nothing if there is no writer.
+		void reset()
+		{
+			std::scoped_lock lock(_mutex);
+			auto* const writer{ _writer.exchange(nullptr) };
+			if (writer == nullptr)
+				return;
+			const auto epoch{ _epoch.load() };
+			drain(epoch ^ 1u);
+			_epoch.store(epoch ^ 1u);
+			drain(epoch); // any thread counted under this epoch from now on sees that there is no writer
+			writer->shutdown();
+			delete writer;
+		}
+
+		/**
+		 * @brief		Call a function with the writer, which remains valid until the function returns.
+		 * @param func	Function that accepts an AsyncLogWriter*, which is nullptr when there is no writer.
+		 * @returns		The value returned by func.
+		 */
+		template<typename Func>
+		decltype(auto) with(Func&& func) const
+		{
+			const struct user {
+				std::atomic<std::uint64_t>& count;
+				explicit user(std::atomic<std::uint64_t>& count) : count{ count } { count.fetch_add(1ull); }
+				~user() { count.fetch_sub(1ull); }
+			} guard{ _users[_epoch.load()] };
+			return std::forward<Func>(func)(_writer.load());
+		}
+		/// @brief	Check if a writer is running.
+		bool has_value() const noexcept { return _writer.load() != nullptr; }
+	};
+}
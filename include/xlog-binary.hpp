@@ -0,0 +1,585 @@
+/**
+ * @file	xlog-binary.hpp
+ * @author	radj307
+ * @brief	Contains the xlog binary log mode, which defers all formatting to an offline decoder.
+ *
+ *	# Example #
+ *
+ *	std::ofstream file{ "app.xlog", std::ios_base::binary };
+ *	xlog::BinaryLog blog{ file };
+ *
+ *	XLOG_BINARY(blog, xlog::level::ERROR, "Failed to open {} after {} attempts", path, attempts);
+ *
+ *	The resulting file is converted to text with the xlog-decode tool:
+ *	xlog-decode app.xlog
+ */
+#pragma once
+#include <xlog.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <istream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+/**
+ * @def		XLOG_BINARY
+ * @brief	Write a message to a BinaryLog. The format string & argument types are registered once per call site; each call only copies the raw argument values.
+ *\n		Compiles away when the level was removed by XLOG_COMPILE_LEVEL.
+ *\n		Each "{}" in the format string is replaced by the next argument when decoded. Arguments without a placeholder are appended to the end.
+ * @param logger	A BinaryLog instance.
+ * @param lvl		The message level, such as xlog::level::ERROR.
+ * @param fmt		A string literal.
+ * @param ...		The message arguments.
+ */
+#define XLOG_BINARY(logger, lvl, fmt, ...) \
+	do { \
+		if constexpr (::xlog::is_compiled_in(lvl)) { \
+			struct _xlog_call_site_tag {}; \
+			::xlog::binary::write_at_call_site<_xlog_call_site_tag>((logger), lvl, fmt, __FILE__, __LINE__ __VA_OPT__(,) __VA_ARGS__); \
+		} \
+	} while (false)
+
+namespace xlog {
+	/**
+	 * @namespace	binary
+	 * @brief		Contains the binary log format used by BinaryLog & BinaryDecoder.
+	 *\n			A stream starts with a Header, followed by any number of entries. Each entry starts with an EntryType byte:
+	 *\n			- DESCRIPTOR:	u32 id, u8 level, u8 argument count, argument types, u32 + format string, u32 + file name, u32 line.
+	 *\n			- RECORD:		u32 call site id, i64 timestamp (nanoseconds since the system clock epoch), argument values.
+	 *\n			Numbers are stored in native byte order; strings are stored as a u32 length followed by their characters.
+	 */
+	namespace binary {
+		/// @brief	The magic bytes at the start of every binary log stream.
+		inline constexpr const char MAGIC[8]{ 'X', 'L', 'O', 'G', 'B', 'I', 'N', '1' };
+		/// @brief	Written after MAGIC, used by the decoder to detect a byte order mismatch.
+		inline constexpr const std::uint32_t BYTE_ORDER_MARK{ 0x01020304u };
+
+		/// @brief	Header flag indicating that messages should be prefixed with their level.
+		inline constexpr const unsigned char FLAG_PREFIX{ 1u };
+		/// @brief	Header flag indicating that prefixes should be colorized.
+		inline constexpr const unsigned char FLAG_COLOR{ 2u };
+
+		enum class EntryType : unsigned char {
+			DESCRIPTOR = 'D',
+			RECORD = 'R',
+		};
+
+		/// @brief	The encoding of a single message argument.
+		enum class ArgType : unsigned char {
+			CHAR = 1,
+			BOOL,
+			INT16,
+			INT32,
+			INT64,
+			UINT16,
+			UINT32,
+			UINT64,
+			FLOAT,
+			DOUBLE,
+			POINTER,
+			/// @brief	Strings, & any other streamable type. Other types are converted with str::stringify when logged.
+			STRING,
+		};
+
+		namespace _internal {
+			template<typename T> using arg_t = std::remove_cvref_t<std::decay_t<T>>;
+
+			template<typename T>
+			inline constexpr ArgType arg_type_of() noexcept
+			{
+				using U = arg_t<T>;
+				if constexpr (std::same_as<U, char> || std::same_as<U, signed char> || std::same_as<U, unsigned char>)
+					return ArgType::CHAR;
+				else if constexpr (std::same_as<U, bool>)
+					return ArgType::BOOL;
+				else if constexpr (std::is_integral_v<U> && sizeof(U) <= 2ull)
+					return std::is_signed_v<U> ? ArgType::INT16 : ArgType::UINT16;
+				else if constexpr (std::is_integral_v<U> && sizeof(U) <= 4ull)
+					return std::is_signed_v<U> ? ArgType::INT32 : ArgType::UINT32;
+				else if constexpr (std::is_integral_v<U> && sizeof(U) <= 8ull)
+					return std::is_signed_v<U> ? ArgType::INT64 : ArgType::UINT64;
+				else if constexpr (std::same_as<U, float>)
+					return ArgType::FLOAT;
+				else if constexpr (std::is_floating_point_v<U>)
+					return ArgType::DOUBLE;
+				else if constexpr (std::is_pointer_v<U> && !std::same_as<U, const char*> && !std::same_as<U, char*>)
+					return ArgType::POINTER;
+				else return ArgType::STRING;
+			}
+
+			/// @brief	Convert an argument to the value that is stored for it. Strings become string_views; unsupported types are stringified.
+			template<typename T>
+			inline auto stored_value(const T& value)
+			{
+				constexpr auto type{ arg_type_of<T>() };
+				if constexpr (type == ArgType::CHAR)
+					return static_cast<char>(value);
+				else if constexpr (type == ArgType::BOOL)
+					return static_cast<unsigned char>(value);
+				else if constexpr (type == ArgType::INT16) return static_cast<std::int16_t>(value);
+				else if constexpr (type == ArgType::INT32) return static_cast<std::int32_t>(value);
+				else if constexpr (type == ArgType::INT64) return static_cast<std::int64_t>(value);
+				else if constexpr (type == ArgType::UINT16) return static_cast<std::uint16_t>(value);
+				else if constexpr (type == ArgType::UINT32) return static_cast<std::uint32_t>(value);
+				else if constexpr (type == ArgType::UINT64) return static_cast<std::uint64_t>(value);
+				else if constexpr (type == ArgType::FLOAT) return static_cast<float>(value);
+				else if constexpr (type == ArgType::DOUBLE) return static_cast<double>(value);
+				else if constexpr (type == ArgType::POINTER) return static_cast<std::uint64_t>(reinterpret_cast<std::uintptr_t>(value));
+				else if constexpr (std::is_convertible_v<const T&, std::string_view>)
+					return std::string_view{ value };
+				else return str::stringify(value);
+			}
+
+			template<typename V>
+			inline std::size_t stored_size(const V& v) noexcept
+			{
+				if constexpr (std::is_convertible_v<const V&, std::string_view>)
+					return sizeof(std::uint32_t) + std::string_view{ v }.size();
+				else return sizeof(V);
+			}
+
+			template<typename V>
+			inline char* store(char* out, const V& v) noexcept
+			{
+				if constexpr (std::is_convertible_v<const V&, std::string_view>) {
+					const std::string_view sv{ v };
+					const auto length{ static_cast<std::uint32_t>(sv.size()) };
+					std::memcpy(out, &length, sizeof(length));
+					std::memcpy(out + sizeof(length), sv.data(), sv.size());
+					return out + sizeof(length) + sv.size();
+				}
+				else {
+					std::memcpy(out, &v, sizeof(V));
+					return out + sizeof(V);
+				}
+			}
+
+			inline void append_string(std::string& out, const std::string_view str)
+			{
+				const auto length{ static_cast<std::uint32_t>(str.size()) };
+				out.append(reinterpret_cast<const char*>(&length), sizeof(length));
+				out.append(str);
+			}
+		}
+
+		/**
+		 * @struct	CallSite
+		 * @brief	The static description of one XLOG_BINARY call site.
+		 */
+		struct CallSite {
+			std::uint32_t id;
+			unsigned char level;
+			std::vector<ArgType> arg_types;
+			std::string format;
+			std::string file;
+			std::uint32_t line;
+
+			/// @brief	Serialize this call site as a DESCRIPTOR entry.
+			void encode(std::string& out) const
+			{
+				out.push_back(static_cast<char>(EntryType::DESCRIPTOR));
+				out.append(reinterpret_cast<const char*>(&id), sizeof(id));
+				out.push_back(static_cast<char>(level));
+				out.push_back(static_cast<char>(arg_types.size()));
+				for (const auto& type : arg_types)
+					out.push_back(static_cast<char>(type));
+				_internal::append_string(out, format);
+				_internal::append_string(out, file);
+				out.append(reinterpret_cast<const char*>(&line), sizeof(line));
+			}
+		};
+
+		/**
+		 * @class	Registry
+		 * @brief	Process-wide, append-only list of registered call sites.
+		 */
+		class Registry {
+			mutable std::mutex _mutex;
+			std::vector<CallSite> _sites;
+
+		public:
+			/// @brief	Get the process-wide registry.
+			static Registry& get()
+			{
+				static Registry instance;
+				return instance;
+			}
+
+			/// @brief	Register a call site, and return its id.
+			std::uint32_t add(const unsigned char level, std::vector<ArgType> arg_types, std::string format, std::string file, const std::uint32_t line)
+			{
+				std::scoped_lock lock(_mutex);
+				const auto id{ static_cast<std::uint32_t>(_sites.size()) };
+				_sites.emplace_back(CallSite{ id, level, std::move(arg_types), std::move(format), std::move(file), line });
+				return id;
+			}
+
+			/// @brief	Get the number of registered call sites.
+			std::size_t size() const
+			{
+				std::scoped_lock lock(_mutex);
+				return _sites.size();
+			}
+
+			/// @brief	Serialize every call site with an id in the range [begin, end) as DESCRIPTOR entries.
+			void encode(std::string& out, const std::size_t begin, const std::size_t end) const
+			{
+				std::scoped_lock lock(_mutex);
+				for (auto i{ begin }; i < end && i < _sites.size(); ++i)
+					_sites[i].encode(out);
+			}
+		};
+
+		/**
+		 * @brief			Write a message from a call site, registering the call site the first time. Used by the XLOG_BINARY macro.
+		 *\n				Registration only depends on the argument types, so the arguments are evaluated exactly once.
+		 * @tparam Tag		A type that is unique to the call site.
+		 * @returns			bool	false when the message was refused by the log level.
+		 */
+		template<typename Tag, typename Logger, typename... Args>
+		inline bool write_at_call_site(Logger& logger, const level::LogLevel& level, const char* format, const char* file, const unsigned line, const Args&... args)
+		{
+			static const std::uint32_t site{ Registry::get().add(level, { _internal::arg_type_of<Args>()... }, format, file, static_cast<std::uint32_t>(line)) };
+			return logger.write(site, level, args...);
+		}
+	}
+
+	/**
+	 * @class	BinaryLog
+	 * @brief	Log that writes compact binary records, leaving all formatting to the xlog-decode tool.
+	 *\n		Each thread appends records to its own buffer, so logging threads don't contend with each other. A buffer is written to the output stream
+	 *\n		when it fills up, when its thread exits, when flush() is called, & when the BinaryLog is destroyed.
+	 *\n		Records from different threads are ordered by timestamp when decoded.
+	 */
+	class BinaryLog {
+		/// @brief	Per-thread record buffer.
+		struct StagingBuffer {
+			std::mutex mutex; ///< @brief Only contended while the owner is flushing.
+			std::string data;
+			BinaryLog* owner;
+			bool exited{ false }; ///< @brief Set when the thread that used the buffer exits, so the owner can discard it.
+		};
+		/// @brief	Thread-local list of the buffers this thread uses, one per BinaryLog. Flushes them when the thread exits.
+		struct ThreadBuffers {
+			std::vector<std::pair<std::uint64_t, std::shared_ptr<StagingBuffer>>> buffers;
+
+			~ThreadBuffers()
+			{
+				for (auto& [_, buffer] : buffers) {
+					std::scoped_lock lock(buffer->mutex);
+					if (buffer->owner != nullptr)
+						buffer->owner->commit(buffer->data);
+					std::string{}.swap(buffer->data); // release the memory now; the owner discards the buffer itself later
+					buffer->exited = true;
+				}
+			}
+		};
+
+		static inline std::atomic<std::uint64_t> _next_id{ 0ull };
+
+		const std::uint64_t _id{ _next_id.fetch_add(1ull, std::memory_order_relaxed) };
+		std::ostream* _target;
+		std::size_t _buffer_size;
+		level::LogLevel _level;
+		std::mutex _target_mutex;		///< @brief Serializes writes to the output stream.
+		std::size_t _described{ 0ull };	///< @brief The number of call sites whose descriptors were written.
+		std::mutex _buffers_mutex;
+		std::vector<std::shared_ptr<StagingBuffer>> _buffers;
+
+		/// @brief	Discard the buffers of threads that have exited. The caller must hold _buffers_mutex.
+		void prune()
+		{
+			std::erase_if(_buffers, [](const auto& buffer) { std::scoped_lock lock(buffer->mutex); return buffer->exited; });
+		}
+
+		/// @brief	Get the calling thread's buffer for this log, creating it if necessary.
+		StagingBuffer& buffer()
+		{
+			thread_local ThreadBuffers local;
+			for (const auto& [id, buffer] : local.buffers)
+				if (id == _id)
+					return *buffer;
+			std::erase_if(local.buffers, [](auto& entry) { std::scoped_lock lock(entry.second->mutex); return entry.second->owner == nullptr; });
+			auto buffer{ std::make_shared<StagingBuffer>() };
+			buffer->owner = this;
+			buffer->data.reserve(_buffer_size);
+			{
+				std::scoped_lock lock(_buffers_mutex);
+				prune();
+				_buffers.emplace_back(buffer);
+			}
+			local.buffers.emplace_back(_id, buffer);
+			return *buffer;
+		}
+
+		/// @brief	Write the contents of a staging buffer to the output stream, preceded by any call site descriptors that weren't written yet. The caller must hold the buffer's mutex.
+		void commit(std::string& data)
+		{
+			if (data.empty())
+				return;
+			std::scoped_lock lock(_target_mutex);
+			// every call site referenced by data was registered before the record was written, so this covers all of them
+			if (const auto registered{ binary::Registry::get().size() }; registered > _described) {
+				std::string descriptors;
+				binary::Registry::get().encode(descriptors, _described, registered);
+				_target->write(descriptors.data(), static_cast<std::streamsize>(descriptors.size()));
+				_described = registered;
+			}
+			_target->write(data.data(), static_cast<std::streamsize>(data.size()));
+			data.clear();
+		}
+
+	public:
+		/**
+		 * @brief				Constructor. Writes the stream header immediately.
+		 * @param target		The output stream. Must be opened in binary mode, and must outlive the BinaryLog.
+		 * @param log_level		The log level whitelist.
+		 * @param add_prefix	When true, decoded messages are prefixed with their level, like xLog.
+		 * @param use_color		When true, decoded prefixes are colorized.
+		 * @param buffer_size	The size each per-thread buffer may reach before it is written to the stream.
+		 */
+		BinaryLog(std::ostream& target, const level::LogLevel& log_level = level::Default, const bool add_prefix = true, const bool use_color = true, const std::size_t buffer_size = 65536ull) : _target{ &target }, _buffer_size{ buffer_size }, _level{ log_level }
+		{
+			const unsigned char flags{ static_cast<unsigned char>((add_prefix ? binary::FLAG_PREFIX : 0u) | (use_color ? binary::FLAG_COLOR : 0u)) };
+			_target->write(binary::MAGIC, sizeof(binary::MAGIC));
+			_target->write(reinterpret_cast<const char*>(&binary::BYTE_ORDER_MARK), sizeof(binary::BYTE_ORDER_MARK));
+			_target->put(static_cast<char>(flags));
+		}
+		BinaryLog(const BinaryLog&) = delete;
+		BinaryLog& operator=(const BinaryLog&) = delete;
+		/// @brief	Destructor. Writes every thread's buffered records.
+		~BinaryLog()
+		{
+			std::scoped_lock lock(_buffers_mutex);
+			for (auto& buffer : _buffers) {
+				std::scoped_lock buffer_lock(buffer->mutex);
+				commit(buffer->data);
+				buffer->owner = nullptr;
+			}
+			_target->flush();
+		}
+
+		/// @brief	Retrieve the current level whitelist setting.
+		[[nodiscard]] level::LogLevel getLevel() const { return _level; }
+
+		/**
+		 * @brief			Append a record to the calling thread's buffer. Use the XLOG_BINARY macro instead of calling this directly.
+		 * @param site		The id of a call site registered by binary::write_at_call_site.
+		 * @param level		The message level. Must match the level the call site was registered with.
+		 * @param ...args	The message arguments.
+		 * @returns			bool	false when the message was refused by the log level.
+		 */
+		template<typename... Args>
+		bool write(const std::uint32_t site, const level::LogLevel& level, const Args&... args)
+		{
+			if (!_level.contains(level))
+				return false;
+			const std::int64_t timestamp{ std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::system_clock::now().time_since_epoch()).count() };
+			const auto values{ std::make_tuple(binary::_internal::stored_value(args)...) };
+			const auto size{ std::apply([](const auto&... v) { return (1ull + sizeof(site) + sizeof(timestamp)) + (0ull + ... + binary::_internal::stored_size(v)); }, values) };
+
+			auto& buf{ buffer() };
+			std::scoped_lock lock(buf.mutex);
+			const auto offset{ buf.data.size() };
+			buf.data.resize(offset + size);
+			char* pos{ buf.data.data() + offset };
+			*pos++ = static_cast<char>(binary::EntryType::RECORD);
+			pos = binary::_internal::store(pos, site);
+			pos = binary::_internal::store(pos, timestamp);
+			std::apply([&pos](const auto&... v) { ((pos = binary::_internal::store(pos, v)), ...); }, values);
+			if (buf.data.size() >= _buffer_size)
+				commit(buf.data);
+			return true;
+		}
+
+		/// @brief	Write every thread's buffered records to the output stream, then flush it.
+		void flush()
+		{
+			std::scoped_lock lock(_buffers_mutex);
+			for (auto& buffer : _buffers) {
+				std::scoped_lock buffer_lock(buffer->mutex);
+				commit(buffer->data);
+			}
+			prune();
+			std::scoped_lock target_lock(_target_mutex);
+			_target->flush();
+		}
+	};
+
+	/**
+	 * @class	BinaryDecoder
+	 * @brief	Converts a binary log stream written by BinaryLog into the same text that xLog would have written.
+	 */
+	class BinaryDecoder {
+		struct Decoded {
+			std::int64_t timestamp;
+			std::string text;
+		};
+
+		bool _add_prefix{ true }, _use_color{ true };
+		std::map<std::uint32_t, binary::CallSite> _sites;
+		std::vector<Decoded> _records;
+
+		template<typename T>
+		static bool read(std::istream& is, T& value)
+		{
+			return static_cast<bool>(is.read(reinterpret_cast<char*>(&value), sizeof(T)));
+		}
+		static bool read(std::istream& is, std::string& str)
+		{
+			std::uint32_t length;
+			if (!read(is, length))
+				return false;
+			str.resize(length);
+			return static_cast<bool>(is.read(str.data(), length));
+		}
+
+		/// @brief	Read one argument & insert it into a stream the same way str::stringify would have.
+		static bool read_arg(std::istream& is, const binary::ArgType type, std::ostream& out)
+		{
+			using binary::ArgType;
+			const auto insert{ [&is, &out]<typename T>(T value) {
+				if (!read(is, value))
+					return false;
+				out << value;
+				return true;
+			} };
+			switch (type) {
+			case ArgType::CHAR: return insert(char{});
+			case ArgType::BOOL: {
+				unsigned char b;
+				if (!read(is, b))
+					return false;
+				out << static_cast<bool>(b);
+				return true;
+			}
+			case ArgType::INT16: return insert(std::int16_t{});
+			case ArgType::INT32: return insert(std::int32_t{});
+			case ArgType::INT64: return insert(std::int64_t{});
+			case ArgType::UINT16: return insert(std::uint16_t{});
+			case ArgType::UINT32: return insert(std::uint32_t{});
+			case ArgType::UINT64: return insert(std::uint64_t{});
+			case ArgType::FLOAT: return insert(float{});
+			case ArgType::DOUBLE: return insert(double{});
+			case ArgType::POINTER: {
+				std::uint64_t p;
+				if (!read(is, p))
+					return false;
+				out << reinterpret_cast<const void*>(static_cast<std::uintptr_t>(p));
+				return true;
+			}
+			case ArgType::STRING: {
+				std::string str;
+				if (!read(is, str))
+					return false;
+				out << str;
+				return true;
+			}
+			default:
+				return false;
+			}
+		}
+
+		bool read_descriptor(std::istream& is)
+		{
+			binary::CallSite site;
+			unsigned char argc;
+			if (!read(is, site.id) || !read(is, site.level) || !read(is, argc))
+				return false;
+			site.arg_types.resize(argc);
+			if (!is.read(reinterpret_cast<char*>(site.arg_types.data()), argc) || !read(is, site.format) || !read(is, site.file) || !read(is, site.line))
+				return false;
+			_sites.insert_or_assign(site.id, std::move(site));
+			return true;
+		}
+
+		bool read_record(std::istream& is)
+		{
+			std::uint32_t id;
+			std::int64_t timestamp;
+			if (!read(is, id) || !read(is, timestamp))
+				return false;
+			const auto it{ _sites.find(id) };
+			if (it == _sites.end())
+				throw make_exception("BinaryDecoder:\tRecord references unknown call site ", id, "!");
+			const auto& site{ it->second };
+
+			std::ostringstream message;
+			std::string_view format{ site.format };
+			for (const auto& type : site.arg_types) {
+				if (const auto placeholder{ format.find("{}") }; placeholder != std::string_view::npos) {
+					message << format.substr(0ull, placeholder);
+					format.remove_prefix(placeholder + 2ull);
+				}
+				else {
+					message << format;
+					format = {};
+				}
+				if (!read_arg(is, type, message))
+					return false;
+			}
+			message << format;
+			_records.emplace_back(Decoded{ timestamp, format_message(site.level, message.str(), _add_prefix, _use_color) });
+			return true;
+		}
+
+	public:
+		/**
+		 * @brief		Read an entire binary log stream.
+		 * @param is	The input stream. Must be opened in binary mode.
+		 * @throws		std::exception	The stream isn't a binary log, or was written on a machine with a different byte order.
+		 */
+		void read(std::istream& is)
+		{
+			char magic[sizeof(binary::MAGIC)];
+			std::uint32_t bom;
+			unsigned char flags;
+			if (!is.read(magic, sizeof(magic)) || !std::equal(std::begin(magic), std::end(magic), std::begin(binary::MAGIC)))
+				throw make_exception("BinaryDecoder:\tInput isn't an xlog binary log!");
+			if (!read(is, bom) || bom != binary::BYTE_ORDER_MARK)
+				throw make_exception("BinaryDecoder:\tInput was written with a different byte order!");
+			if (!read(is, flags))
+				throw make_exception("BinaryDecoder:\tInput is truncated!");
+			_add_prefix = (flags & binary::FLAG_PREFIX) != 0;
+			_use_color = (flags & binary::FLAG_COLOR) != 0;
+
+			for (int type{ is.get() }; type != std::char_traits<char>::eof(); type = is.get()) {
+				bool ok{ false };
+				if (type == static_cast<int>(binary::EntryType::DESCRIPTOR))
+					ok = read_descriptor(is);
+				else if (type == static_cast<int>(binary::EntryType::RECORD))
+					ok = read_record(is);
+				if (!ok)
+					throw make_exception("BinaryDecoder:\tInput is corrupted or truncated!");
+			}
+		}
+
+		/**
+		 * @brief		Write the decoded messages in timestamp order, one per line, like OutputTarget::write.
+		 * @param os	The output stream.
+		 */
+		void write(std::ostream& os)
+		{
+			std::stable_sort(_records.begin(), _records.end(), [](const Decoded& a, const Decoded& b) { return a.timestamp < b.timestamp; });
+			for (const auto& [_, text] : _records) {
+				os << text;
+				if (!text.empty() && text.back() != '\n')
+					os << '\n';
+			}
+		}
+
+		/// @brief	Get the number of decoded messages.
+		std::size_t size() const noexcept { return _records.size(); }
+	};
+}
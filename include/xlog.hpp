@@ -3,12 +3,20 @@
  * @author	radj307
  * @brief	Contains the xlog _(eXtensible LOG)_ namespace, a framework for implementing console logs into C++ programs.
  */
+#pragma once
 #include <str.hpp>		// str-lib
 #include <Message.hpp>	// TermAPI
+#include <xlog-async.hpp>
 
+#include <atomic>
 #include <iostream>
-#include <string>
+#include <memory>
+#include <mutex>
 #include <optional>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
 
 #pragma region UndefineMicrosoftBullshitMacros
 #ifdef ERROR
@@ -25,6 +33,16 @@
 #undef XLOG_INCLUDE_SELF
 #else
 #define XLOG_LEVEL_SELF
+#endif
+
+ /**
+  * @def	XLOG_COMPILE_LEVEL
+  * @brief	The levels that are compiled into the program. Define this before including <xlog.hpp> to remove other levels at compile time,
+  *\n		for example `-DXLOG_COMPILE_LEVEL=xlog::level::OnlyErrorsAndWarnings`. Messages with other levels are always refused,
+  *\n		and statements written with the XLOG & XLOGS macros compile away entirely, including their arguments.
+  */
+#ifndef XLOG_COMPILE_LEVEL
+#define XLOG_COMPILE_LEVEL 0xFF
 #endif
 
   /**
@@ -73,7 +91,7 @@ namespace xlog {
 		 */
 		struct LogLevel {
 		private:
-			const unsigned char _level; // this is a char because they use one byte and allow multiple values
+			unsigned char _level; // this is a char because they use one byte and allow multiple values
 		public:
 			constexpr LogLevel(const unsigned char& level) : _level{ level } {}
 			constexpr operator const unsigned char() const { return _level; }
@@ -140,6 +158,16 @@ namespace xlog {
 		level::NoErrorsDebug{ DEBUG | NoErrors },
 		level::NoErrorsOrWarningsDebug{ DEBUG | NoErrorsOrWarnings };
 
+	/// @brief	The levels that are compiled into the program. See XLOG_COMPILE_LEVEL.
+	inline constexpr const level::LogLevel compiled_levels{ static_cast<unsigned char>(XLOG_COMPILE_LEVEL) };
+
+	/**
+	 * @brief			Check if a level is compiled into the program.
+	 * @param level		A log level.
+	 * @returns			bool
+	 */
+	inline constexpr bool is_compiled_in(const level::LogLevel& level) { return compiled_levels.contains(level); }
+
 	/**
 	 * @struct				OutputTarget
 	 * @brief				Represents a method of outputting the logs generated by the program.
@@ -161,6 +189,54 @@ namespace xlog {
 		}
 	};
 
+	/**
+	 * @brief				Get the message type that provides the prefix for a log level.
+	 * @param level			A single base log level.
+	 * @returns				const sys::term::Message*	nullptr when the level has no prefix.
+	 */
+	inline const sys::term::Message* get_message_type(const level::LogLevel& level)
+	{
+		switch (level) {
+		case level::CRITICAL:
+			return &sys::term::crit;
+		case level::ERROR:
+			return &sys::term::error;
+		case level::WARNING:
+			return &sys::term::warn;
+		case level::LOG:
+			return &sys::term::log;
+		case level::INFO:
+			return &sys::term::info;
+		case level::MESSAGE:
+			return &sys::term::msg;
+		case level::DEBUG:
+			return &sys::term::debug;
+		default:
+			return nullptr;
+		}
+	}
+
+	/**
+	 * @brief				Format a log message the way xLog writes it to its output target.
+	 * @param level			The log level associated with this message.
+	 * @param message		The message string.
+	 * @param add_prefix	When true, the message is prefixed with its level, such as "[ERROR]".
+	 * @param use_color		When true, the prefix is colorized. xLog disables this for std::ofstream targets.
+	 * @returns				std::string
+	 */
+	inline std::string format_message(const level::LogLevel& level, const std::string& message, const bool add_prefix, const bool use_color)
+	{
+		if (!add_prefix)
+			return message;
+		if (const auto* message_type{ get_message_type(level) }; message_type != nullptr) {
+			const auto& prefix{ message_type->prefix(use_color) };
+			std::string formatted;
+			formatted.reserve(prefix.size() + message.size());
+			return formatted.append(prefix).append(message);
+		}
+		return str::stringify(str::VIndent(sys::term::message_settings::maxMessageSizeIndent), message);
+	}
+
 	/**
 	 * @class				xLog
 	 * @brief				Logging object.
@@ -170,8 +246,10 @@ namespace xlog {
 	class xLog {
 	protected:
 		OutputTarget<StreamType> _target;
-		std::unique_ptr<level::LogLevel> _level;
-		bool _add_prefix, _log_self{ false };
+		std::atomic<level::LogLevel> _level;
+		std::atomic<bool> _add_prefix, _log_self{ false };
+		mutable std::mutex _write_mutex; ///< @brief Held only while a formatted message is written to the target, so that messages from different threads don't interleave.
+		AsyncWriterSlot _async; ///< @brief The background writer when asynchronous mode is enabled. Declared last, so that it is stopped before the other members are destroyed.
 
 		/**
 		 * @brief			Format a given message using the current settings.
@@ -181,41 +259,7 @@ namespace xlog {
 		 */
 		std::string format(const level::LogLevel& level, const std::string& message) const
 		{
-			if (!_add_prefix)
-				return message;
-			const sys::term::Message* message_type{ nullptr };
-			switch (level) {
-			case level::CRITICAL:
-				message_type = &sys::term::crit;
-				break;
-			case level::ERROR:
-				message_type = &sys::term::error;
-				break;
-			case level::WARNING:
-				message_type = &sys::term::warn;
-				break;
-			case level::LOG:
-				message_type = &sys::term::log;
-				break;
-			case level::INFO:
-				message_type = &sys::term::info;
-				break;
-			case level::MESSAGE:
-				message_type = &sys::term::msg;
-				break;
-			case level::DEBUG:
-				message_type = &sys::term::debug;
-				break;
-			default:
-				break;
-			}
-			if (message_type != nullptr) {
-				if constexpr (std::derived_from<StreamType, std::ofstream>)
-					return { message_type->as_string_no_color() + message };
-				else
-					return { message_type->as_string() + message };
-			}
-			return str::stringify(str::VIndent(sys::term::message_settings::maxMessageSizeIndent), message);
+			return format_message(level, message, _add_prefix.load(std::memory_order_relaxed), !std::derived_from<StreamType, std::ofstream>);
 		}
 
 		/**
@@ -225,9 +269,14 @@ namespace xlog {
 		 */
 		bool currentLevelContains(const level::LogLevel& level) const
 		{
-			if (_level.get() != nullptr)
-				return (*_level.get()).contains(level);
-			return false;
+			return is_compiled_in(level) && _level.load(std::memory_order_relaxed).contains(level);
+		}
+
+		/// @brief	Write a formatted message to the output target. Safe to call from multiple threads.
+		void write(const std::string& formatted) const
+		{
+			std::scoped_lock lock(_write_mutex);
+			_target.write(formatted);
 		}
 
 		/**
@@ -241,8 +290,51 @@ namespace xlog {
 			return _log_self && currentLevelContains(level::DEBUG) && log(level::DEBUG, message...);
 		}
 
+		/// @brief	Get the options of the background writer, or std::nullopt when asynchronous mode is disabled.
+		std::optional<AsyncOptions> asyncOptions() const
+		{
+			return _async.with([](const AsyncLogWriter* async) -> std::optional<AsyncOptions> {
+				if (async == nullptr)
+					return std::nullopt;
+				return AsyncOptions{ async->capacity(), async->policy() };
+			});
+		}
+
 	public:
-		xLog(const OutputTarget<StreamType>& out = OutputTarget<StreamType>{ std::cerr }, const level::LogLevel& log_level = level::Default, const bool& add_prefix = true) : _target{ out }, _level{ std::make_unique<level::LogLevel>(log_level) }, _add_prefix{ add_prefix } {}
+		xLog(const OutputTarget<StreamType>& out = OutputTarget<StreamType>{ std::cerr }, const level::LogLevel& log_level = level::Default, const bool& add_prefix = true) : _target{ out }, _level{ log_level }, _add_prefix{ add_prefix } {}
+		/**
+		 * @brief	Move constructor. When o is in asynchronous mode, its queued messages are written first, & asynchronous mode moves to the new instance.
+		 *\n		No other thread may be using o.
+		 */
+		xLog(xLog&& o) : _target{ o._target }, _level{ o._level.load() }, _add_prefix{ o._add_prefix.load() }, _log_self{ o._log_self.load() }
+		{
+			if (const auto options{ o.asyncOptions() }; options.has_value()) {
+				o.disableAsync();
+				enableAsync(*options);
+			}
+		}
+		/**
+		 * @brief	Move assignment operator. Messages queued by either instance are written first, & asynchronous mode moves with o's other settings.
+		 *\n		No other thread may be using either instance.
+		 */
+		xLog& operator=(xLog&& o)
+		{
+			if (this == &o)
+				return *this;
+			disableAsync();
+			const auto options{ o.asyncOptions() };
+			o.disableAsync();
+			{
+				std::scoped_lock lock(_write_mutex);
+				_target = o._target;
+			}
+			_level.store(o._level.load());
+			_add_prefix.store(o._add_prefix.load());
+			_log_self.store(o._log_self.load());
+			if (options.has_value())
+				enableAsync(*options);
+			return *this;
+		}
 
 		friend std::istream& operator>>(std::istream& is, const xLog<StreamType>& x) { return is >> x._target; }
 		friend std::ostream& operator<<(std::ostream& os, const xLog<StreamType>& x) { return os << x._target; }
@@ -254,9 +346,7 @@ namespace xlog {
 		 */
 		bool setPrefixEnabled(const bool& enable)
 		{
-			const auto copy{ _add_prefix };
-			_add_prefix = enable;
-			return copy;
+			return _add_prefix.exchange(enable);
 		}
 
 		/**
@@ -266,28 +356,72 @@ namespace xlog {
 		 */
 		level::LogLevel setLevel(const level::LogLevel& level)
 		{
-			const auto copy{ *_level.release() };
-			_level = std::make_unique<level::LogLevel>(level);
-
-			return copy;
+			return _level.exchange(level);
 		}
 
 		/// @brief	Retrieve the current level whitelist setting.
-		[[nodiscard]] level::LogLevel getLevel() const { return *_level.get(); }
+		[[nodiscard]] level::LogLevel getLevel() const { return _level.load(); }
+
+		/**
+		 * @brief			Enable asynchronous mode. Messages are stringified on the calling thread, then formatted & written to the output target by a background thread.
+		 *\n				While asynchronous mode is enabled, settings such as setPrefixEnabled apply to messages when they are written.
+		 *\n				Safe to call while other threads are logging.
+		 * @param options	Queue capacity & overflow policy.
+		 * @returns			bool	false if asynchronous mode was already enabled.
+		 */
+		bool enableAsync(const AsyncOptions& options = {})
+		{
+			return _async.emplace([this](const LogRecord& record) {
+				write(format(record.level, record.message));
+			}, options);
+		}
+		/**
+		 * @brief	Write every queued message, stop the background thread, and return to synchronous mode.
+		 *\n		Safe to call while other threads are logging; messages that are being queued when it is called are written before the background thread stops.
+		 */
+		void disableAsync() { _async.reset(); }
+		/// @brief	Check if asynchronous mode is enabled.
+		[[nodiscard]] bool isAsync() const { return _async.has_value(); }
+		/// @brief	Get the number of messages discarded by the overflow policy since asynchronous mode was enabled.
+		[[nodiscard]] std::uint64_t droppedCount() const
+		{
+			return _async.with([](const AsyncLogWriter* async) { return async != nullptr ? async->droppedCount() : 0ull; });
+		}
+
+		/// @brief	Block until every message logged before this call has been written, then flush the output target.
+		void flush() const
+		{
+			_async.with([](AsyncLogWriter* async) {
+				if (async != nullptr)
+					async->flush();
+			});
+			if constexpr (requires(StreamType & s) { s.flush(); }) {
+				std::scoped_lock lock(_write_mutex);
+				_target.target->flush();
+			}
+		}
 
 		/**
 		 * @brief				Create a message and send it to the current output target.
+		 *\n					In asynchronous mode, the message is queued instead; formatting & writing happen on the background thread.
 		 * @tparam ...Message	Any number of types that can be inserted into a stream with operator<<.
 		 * @param level			This message's level.
 		 * @param ...msg		The contents of this message.
-		 * @returns				bool
+		 * @returns				bool	false when the message was refused by the log level, or dropped by the overflow policy.
 		 */
 		template<typename... Message>
 		inline bool log(const level::LogLevel& level, const Message&... msg) const
 		{
 			const auto allowed{ currentLevelContains(level) };
-			if (allowed)
-				_target.write(format(level, str::stringify(msg...)));
+			if (allowed) {
+				if (const auto queued{ _async.with([&](AsyncLogWriter* async) -> std::optional<bool> {
+					if (async == nullptr)
+						return std::nullopt;
+					return async->push(LogRecord{ level, str::stringify(msg...) });
+				}) }; queued.has_value())
+					return *queued;
+				write(format(level, str::stringify(msg...)));
+			}
 			else
 				self_log("Refused a message because the current log level does not allow messages of that type.");
 			return allowed;
@@ -304,8 +438,39 @@ namespace xlog {
 	 */
 	template<class StreamType = std::ostream>
 	class xLogs : public xLog<StreamType> {
-		std::unique_ptr<level::LogLevel> _last{ nullptr };
-		std::stringstream _buffer;
+		/// @brief	The state of the message that a thread is currently assembling.
+		struct Assembly {
+			std::optional<level::LogLevel> last{ std::nullopt };
+			bool accepting{ false }; ///< @brief Whether the current message passes the level filter. Tokens are only formatted when this is true.
+			bool checked{ false }; ///< @brief Whether accepting was evaluated for the current message. Cleared by endm, so that level changes apply to the next message.
+			std::ostringstream buffer;
+		};
+		/// @brief	Check if the message that a thread is assembling passes the level filter, evaluating the filter on the message's first token.
+		bool accepts(Assembly& state) const
+		{
+			if (!state.checked) {
+				state.accepting = state.last.has_value() && this->currentLevelContains(*state.last);
+				state.checked = true;
+			}
+			return state.accepting;
+		}
+
+		/// @brief	Thread-local list of the messages this thread is assembling, one per xLogs instance.
+		using AssemblyList = std::vector<std::pair<std::weak_ptr<const void>, std::unique_ptr<Assembly>>>;
+
+		/// @brief	Identifies this instance in each thread's AssemblyList. Entries whose token has expired belong to destroyed instances.
+		std::shared_ptr<const void> _token{ std::make_shared<const char>('\0') };
+
+		/// @brief	Get the calling thread's message assembly state for this instance.
+		Assembly& assembly()
+		{
+			thread_local AssemblyList list;
+			for (const auto& [token, state] : list)
+				if (!token.owner_before(_token) && !_token.owner_before(token))
+					return *state;
+			std::erase_if(list, [](const auto& entry) { return entry.first.expired(); });
+			return *list.emplace_back(_token, std::make_unique<Assembly>()).second;
+		}
 
 	public:
 		/**
@@ -315,13 +480,26 @@ namespace xlog {
 		 * @param add_prefix	When true, log messages are prefixed with their level.
 		 */
 		xLogs(const OutputTarget<StreamType>& out = OutputTarget<StreamType>{ std::cerr }, const level::LogLevel& log_level = level::Default, const bool& add_prefix = true) : xLog<StreamType>(out, log_level, add_prefix) {}
+		/// @brief	Move constructor. Messages that threads were assembling with o are continued by the new instance. No other thread may be using o.
+		xLogs(xLogs&& o) : xLog<StreamType>(std::move(o)), _token{ std::exchange(o._token, std::make_shared<const char>('\0')) } {}
+		/// @brief	Move assignment operator. Messages that threads were assembling with o are continued by this instance. No other thread may be using either instance.
+		xLogs& operator=(xLogs&& o)
+		{
+			if (this != &o) {
+				xLog<StreamType>::operator=(std::move(o));
+				_token = std::exchange(o._token, std::make_shared<const char>('\0'));
+			}
+			return *this;
+		}
 
 		/**
 		 * @brief		Stream insertion operator for the xLogs class.
 		 *\n			Allows using xLogs in the same way as a std::ostream, with some important changes:
-		 *\n			- A message level must be specified before messages can be inserted, unless prefixes are disabled.
+		 *\n			- A message level must be specified before messages can be inserted.
 		 *\n			- Messages are terminated with `endm` / nullptr.
 		 *\n			- Messages are only sent to the output target once endm has been received.
+		 *\n			- The level filter is checked on the first token of each message; tokens of messages that are filtered out are discarded without being formatted.
+		 *\n			- Each thread assembles its own message, so any number of threads can use the same instance. Each endm writes one complete message.
 		 * @tparam T	Input Type
 		 * @param oxl	(implicit) xLogs instance.
 		 * @param m		(implicit) Message type.
@@ -329,17 +507,25 @@ namespace xlog {
 		template<var::Streamable T>
 		friend xLogs<StreamType>& operator<<(xLogs<StreamType>& oxl, const T& m)
 		{
-			if constexpr (std::same_as<T, level::LogLevel>)
-				oxl._last = std::make_unique<level::LogLevel>(m);
+			auto& state{ oxl.assembly() };
+			if constexpr (std::same_as<T, level::LogLevel>) {
+				state.last = m;
+				state.checked = false;
+			}
 			else if constexpr (std::same_as<T, msg_break_t>) {
-				if (!oxl._add_prefix || oxl._last.get() == nullptr)
-					oxl.log(level::NONE, oxl._buffer.str());
-				else
-					oxl.log(*oxl._last.get(), oxl._buffer.str());
-				oxl._buffer = {};
+				if (oxl.accepts(state)) {
+					oxl.log(*state.last, state.buffer.str());
+					// reuse the buffer, but discard any manipulators (std::hex, std::setprecision, etc.) so they don't leak into the next message
+					static const std::ostringstream pristine;
+					state.buffer.str(std::string{});
+					state.buffer.clear();
+					state.buffer.copyfmt(pristine);
+				}
+				else oxl.self_log("Refused a message because the current log level does not allow messages of that type.");
+				state.checked = false;
 			}
-			else if (!oxl._add_prefix || oxl._last.get() != nullptr)
-				oxl._buffer << m;
+			else if (oxl.accepts(state))
+				state.buffer << m;
 			return oxl;
 		}
 		/**
@@ -349,7 +535,24 @@ namespace xlog {
 		 */
 		friend xLogs<StreamType>& operator<<(xLogs<StreamType>& oxl, std::ostream& os)
 		{
-			oxl << os.rdbuf();
+			return oxl << os.rdbuf();
 		}
 	};
-}
\ No newline at end of file
+}
+
+/**
+ * @def		XLOG
+ * @brief	Calls xLog::log, unless the level was removed by XLOG_COMPILE_LEVEL, in which case the statement & its arguments compile away.
+ * @param logger	An xLog or xLogs instance.
+ * @param lvl		A constant log level, such as xlog::level::DEBUG.
+ * @param ...		The message contents.
+ */
+#define XLOG(logger, lvl, ...) if constexpr (!::xlog::is_compiled_in(lvl)) {} else (logger).log(lvl, __VA_ARGS__)
+/**
+ * @def		XLOGS
+ * @brief	Starts an xLogs stream message, unless the level was removed by XLOG_COMPILE_LEVEL, in which case the statement & its arguments compile away.
+ *\n		Example: XLOGS(logger, xlog::level::DEBUG) << "value: " << value << xlog::endm;
+ * @param logger	An xLogs instance.
+ * @param lvl		A constant log level, such as xlog::level::DEBUG.
+ */
+#define XLOGS(logger, lvl) if constexpr (!::xlog::is_compiled_in(lvl)) {} else (logger) << (lvl)
@@ -24,7 +24,7 @@ color::ColorFormat color::setcolor::addFormat(const FormatFlag& modFormat)
 color::ColorFormat color::setcolor::removeFormat(const FormatFlag& modFormat)
 {
 	const auto copy{ _format };
-	_format &= modFormat;
+	_format &= static_cast<unsigned char>(~modFormat);
 	return copy;
 }
 bool color::setcolor::operator==(const setcolor& o) const
@@ -0,0 +1,66 @@
+/**
+ * @file	csi-encode-bench.cpp
+ * @author	radj307
+ * @brief	Benchmark that compares the ways of building a cursor position sequence (ESC[<row>;<column>H) with runtime parameters.
+ *\n		Usage: csi-encode-bench [ITERATIONS]
+ *\n		Prints the average time per sequence for str::stringify, ANSI::make_sequence, & ANSI::make_fixed_sequence.
+ */
+#include <Sequence.hpp>
+#include <make_exception.hpp>
+
+#include <chrono>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <string>
+
+namespace {
+	/// @brief	Prevents the compiler from discarding the sequences that are built.
+	volatile std::size_t sink{ 0ull };
+
+	/**
+	 * @brief				Build a sequence for every position in a 200x60 window, repeatedly, & print the average time per sequence.
+	 * @param name			The name of the method, shown in the output.
+	 * @param iterations	The number of sequences to build.
+	 * @param build			Function that accepts a row & column, & returns the number of characters in the sequence it built.
+	 */
+	template<typename Func>
+	void run(const char* name, const std::uint64_t iterations, Func&& build)
+	{
+		std::size_t total{ 0ull };
+		const auto begin{ std::chrono::steady_clock::now() };
+		for (std::uint64_t i{ 0ull }; i < iterations; ++i)
+			total += build(static_cast<unsigned>(i % 60ull) + 1u, static_cast<unsigned>(i % 200ull) + 1u);
+		const auto elapsed{ std::chrono::steady_clock::now() - begin };
+		sink = sink + total;
+		const auto ns{ std::chrono::duration<double, std::nano>(elapsed).count() / static_cast<double>(iterations) };
+		std::cout << std::left << std::setw(20) << name << std::right << std::fixed << std::setprecision(1) << std::setw(10) << ns << " ns/sequence\n";
+	}
+}
+
+int main(const int argc, char** argv)
+{
+	try {
+		using namespace ANSI;
+		const std::uint64_t iterations{ argc > 1 ? std::stoull(argv[1]) : 2000000ull };
+		if (iterations == 0ull)
+			throw make_exception("The number of iterations must be greater than zero!");
+		std::cout << "Building " << iterations << " cursor position sequences with each method:\n";
+
+		run("str::stringify", iterations, [](const unsigned row, const unsigned column) {
+			return str::stringify(ESC, CSI, row, ';', column, 'H').size();
+		});
+		run("make_sequence", iterations, [](const unsigned row, const unsigned column) {
+			return make_sequence(ESC, CSI, row, ';', column, 'H').size();
+		});
+		run("make_fixed_sequence", iterations, [](const unsigned row, const unsigned column) {
+			return make_fixed_sequence(ESC, CSI, row, ';', column, 'H').size();
+		});
+		return 0;
+	} catch (const std::exception& ex) {
+		std::cerr << ex.what() << std::endl;
+	} catch (...) {
+		std::cerr << "An unknown exception occurred!" << std::endl;
+	}
+	return 1;
+}
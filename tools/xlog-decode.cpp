@@ -0,0 +1,34 @@
+/**
+ * @file	xlog-decode.cpp
+ * @author	radj307
+ * @brief	Command-line tool that converts binary logs written by xlog::BinaryLog into text.
+ *\n		Usage: xlog-decode [FILE...]
+ *\n		Reads from STDIN when no files are given, and writes the decoded messages to STDOUT in timestamp order.
+ */
+#include <xlog-binary.hpp>
+
+#include <fstream>
+#include <iostream>
+
+int main(const int argc, char** argv)
+{
+	try {
+		std::ios_base::sync_with_stdio(false);
+		xlog::BinaryDecoder decoder;
+		if (argc < 2)
+			decoder.read(std::cin);
+		else for (int i{ 1 }; i < argc; ++i) {
+			std::ifstream file{ argv[i], std::ios_base::binary };
+			if (!file.is_open())
+				throw make_exception("Couldn't open file: \"", argv[i], "\"!");
+			decoder.read(file);
+		}
+		decoder.write(std::cout);
+		return 0;
+	} catch (const std::exception& ex) {
+		std::cerr << sys::term::error << ex.what() << std::endl;
+	} catch (...) {
+		std::cerr << sys::term::crit << "An unknown exception occurred!" << std::endl;
+	}
+	return 1;
+}